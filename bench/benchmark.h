@@ -0,0 +1,172 @@
+/*
+	Minimal benchmark runner for the engine bench.
+	Every benchmark is calibrated to run for a set time per sample, the median of the samples is reported.
+	Results are written as JSON or CSV so baselines can be kept and compared between builds.
+
+	Configured through the environment since the engine entrypoint owns main:
+		ENGINE_BENCH_FILTER - only run benchmarks whose name contains this text
+		ENGINE_BENCH_TIME - seconds per sample, defaults to 0.1
+		ENGINE_BENCH_SAMPLES - samples per benchmark, defaults to 5
+		ENGINE_BENCH_FORMAT - json or csv, defaults to json
+		ENGINE_BENCH_OUT - output file, defaults to engine-bench.json or engine-bench.csv
+*/
+#pragma once
+#include <engine/engine.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace bench {
+
+	/*
+		Keeps the compiler from optimizing away a value whose computation is benchmarked
+	*/
+	template<typename T>
+	inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		static const void* volatile sink;
+		sink = &value;
+#endif
+	}
+
+	struct Result {
+		std::string name;
+		uint64_t iterations = 0;		// Per sample
+		uint32_t samples = 0;
+		double medianNs = 0.0;			// Per iteration
+		double minNs = 0.0;
+		double maxNs = 0.0;
+		uint64_t items = 1;				// Work items per iteration, e.g. collision tests or quads
+
+		double itemsPerSecond() const { return medianNs > 0.0 ? items * 1.0e9 / medianNs : 0.0; }
+	};
+
+	class Runner {
+	public:
+		Runner() {
+			if (const char* value = std::getenv("ENGINE_BENCH_FILTER")) { m_Filter = value; }
+			if (const char* value = std::getenv("ENGINE_BENCH_TIME")) { m_SampleSeconds = std::strtod(value, nullptr); }
+			if (const char* value = std::getenv("ENGINE_BENCH_SAMPLES")) { m_Samples = (uint32_t)std::strtoul(value, nullptr, 10); }
+			if (const char* value = std::getenv("ENGINE_BENCH_FORMAT")) { m_Format = value; }
+			if (m_SampleSeconds <= 0.0) { m_SampleSeconds = 0.1; }
+			if (m_Samples == 0) { m_Samples = 1; }
+			if (m_Format != "json" && m_Format != "csv") {
+				APP_WARN("Unknown ENGINE_BENCH_FORMAT {0}, expected json or csv", m_Format);
+				m_Format = "json";
+			}
+			m_OutPath = "engine-bench." + m_Format;
+			if (const char* value = std::getenv("ENGINE_BENCH_OUT")) { m_OutPath = value; }
+		}
+
+		bool enabled(const std::string& name) const {
+			return m_Filter.empty() || name.find(m_Filter) != std::string::npos;
+		}
+
+		/*
+			Runs function repeatedly, items is the work done per call for throughput.
+			Iterations double until a batch takes a tenth of the sample time, then they are scaled to fill it.
+		*/
+		template<typename F>
+		void run(const std::string& name, uint64_t items, F&& function) {
+			if (!enabled(name)) { return; }
+
+			uint64_t iterations = 1;
+			for (;;) {
+				double seconds = time(function, iterations);
+				if (seconds >= m_SampleSeconds / 10.0 || iterations >= (1ull << 40)) {
+					double scaled = iterations * m_SampleSeconds / (seconds > 0.0 ? seconds : 1.0e-9);
+					iterations = scaled < 1.0 ? 1 : (uint64_t)scaled;
+					break;
+				}
+				iterations *= 2;
+			}
+
+			std::vector<double> perIteration(m_Samples);
+			for (auto& sample : perIteration) {
+				sample = time(function, iterations) * 1.0e9 / iterations;
+			}
+			std::sort(perIteration.begin(), perIteration.end());
+
+			Result result;
+			result.name = name;
+			result.iterations = iterations;
+			result.samples = m_Samples;
+			result.medianNs = perIteration[perIteration.size() / 2];
+			result.minNs = perIteration.front();
+			result.maxNs = perIteration.back();
+			result.items = items;
+			m_Results.push_back(result);
+		}
+
+		const std::vector<Result>& getResults() const { return m_Results; }
+
+		bool write() const {
+			std::ofstream file(m_OutPath);
+			if (!file) {
+				APP_ERROR("Could not write benchmark results to {0}", m_OutPath);
+				return false;
+			}
+			m_Format == "csv" ? writeCSV(file) : writeJSON(file);
+			APP_INFO("{0} benchmark results written to {1}", m_Results.size(), m_OutPath);
+			return true;
+		}
+
+		void logSummary() const {
+			for (const auto& result : m_Results) {
+				APP_INFO("{0:<40} {1:>12.1f} ns {2:>14.0f} items/s", result.name, result.medianNs, result.itemsPerSecond());
+			}
+		}
+
+	private:
+		/*
+			Benchmarks never swap buffers, the null backend recording is cleared every iteration so it does not grow.
+			Clearing pointers only resets the size, it costs nothing next to any benchmarked call.
+		*/
+		template<typename F>
+		static double time(F& function, uint64_t iterations) {
+			auto start = std::chrono::steady_clock::now();
+			for (uint64_t i = 0; i < iterations; i++) {
+				engine::NullContext::clearCommands();
+				function();
+			}
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// Names are built from identifiers and file stems, no escaping needed
+		void writeJSON(std::ofstream& file) const {
+			char line[512];
+			file << "{\"benchmarks\":[";
+			for (size_t i = 0; i < m_Results.size(); i++) {
+				const Result& result = m_Results[i];
+				snprintf(line, sizeof(line),
+					"%s\n{\"name\":\"%s\",\"iterations\":%llu,\"samples\":%u,\"median_ns\":%.3f,\"min_ns\":%.3f,\"max_ns\":%.3f,\"items\":%llu,\"items_per_second\":%.1f}",
+					i ? "," : "", result.name.c_str(), (unsigned long long)result.iterations, result.samples,
+					result.medianNs, result.minNs, result.maxNs, (unsigned long long)result.items, result.itemsPerSecond());
+				file << line;
+			}
+			file << "\n]}\n";
+		}
+
+		void writeCSV(std::ofstream& file) const {
+			char line[512];
+			file << "name,iterations,samples,median_ns,min_ns,max_ns,items,items_per_second\n";
+			for (const auto& result : m_Results) {
+				snprintf(line, sizeof(line), "%s,%llu,%u,%.3f,%.3f,%.3f,%llu,%.1f\n",
+					result.name.c_str(), (unsigned long long)result.iterations, result.samples,
+					result.medianNs, result.minNs, result.maxNs, (unsigned long long)result.items, result.itemsPerSecond());
+				file << line;
+			}
+		}
+
+		std::string m_Filter;
+		double m_SampleSeconds = 0.1;
+		uint32_t m_Samples = 5;
+		std::string m_Format = "json";
+		std::string m_OutPath;
+		std::vector<Result> m_Results;
+	};
+
+}
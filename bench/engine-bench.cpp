@@ -0,0 +1,474 @@
+/*
+	engine_bench - CPU benchmarks of the engine and game hot paths.
+	Runs on the null backend by default so GL calls cost nothing and only CPU work is measured,
+	ENGINE_BACKEND=offscreen measures with a real driver instead. See bench/benchmark.h for options.
+*/
+#include <engine/engine.h>
+#include <engine/include/graphics/3D-processing/mesh-simplifier.h>
+
+#include "bench/benchmark.h"
+#include "pacman/include/inanimate-objects/map.h"
+
+namespace {
+
+	const uint32_t QUADCOUNT = 10000;	// Quads per scene, several batches with the default batch size
+
+	const std::pair<CollisionKernel, const char*> KERNELS[] = {
+		{ CollisionKernel::Scalar, "scalar" }, { CollisionKernel::SSE2, "sse2" }, { CollisionKernel::AVX2, "avx2" }
+	};
+
+	/*
+		Random boxes spread over a maze sized area, seeded so every run tests the same layout
+	*/
+	std::vector<glm::vec3> randomPositions(uint32_t count) {
+		std::mt19937 generator(42);
+		std::uniform_real_distribution<float> x(0.0f, 28.0f), y(0.0f, 36.0f);
+		std::vector<glm::vec3> positions(count);
+		for (auto& position : positions) {
+			position = { x(generator), y(generator), 0.0f };
+		}
+		return positions;
+	}
+
+	/*
+		Writes the level tiled scale by scale times to the temp directory, returns its path or empty on failure.
+		Only the first player tile is kept, the copies get pellets there instead.
+	*/
+	std::string writeScaledLevel(const std::string& levelPath, int scale) {
+		std::ifstream source(levelPath);
+		int rows = 0, columns = 0;
+		source >> rows;
+		source.ignore(1, 'x');
+		source >> columns;
+		if (!source || rows <= 0 || columns <= 0) { return ""; }
+
+		std::vector<int> tiles((size_t)rows * columns);		// Stored as in the file, one line per column
+		for (auto& tile : tiles) {
+			source >> tile;
+		}
+		if (!source) { return ""; }
+
+		auto path = std::filesystem::temp_directory_path() / ("engine-bench-level0x" + std::to_string(scale) + ".txt");
+		std::ofstream level(path);
+		if (!level) { return ""; }
+		level << rows * scale << 'x' << columns * scale << '\n';
+		for (int column = 0; column < columns * scale; column++) {
+			for (int row = 0; row < rows * scale; row++) {
+				int tile = tiles[(size_t)(column % columns) * rows + row % rows];
+				if (tile == 2 && (row >= rows || column >= columns)) { tile = 0; }
+				level << tile << (row + 1 < rows * scale ? ' ' : '\n');
+			}
+		}
+		return path.string();
+	}
+
+}
+
+class BenchLayer : public engine::Layer {
+public:
+	BenchLayer() : engine::Layer("BenchLayer") {}
+
+	void onUpdate(engine::Time ts) override {
+		if (m_Done) { return; }
+		m_Done = true;
+
+		// Loading warnings and level logs would drown the results
+		auto engineLevel = engine::Logger::getEngineLogger()->level();
+		auto appLevel = engine::Logger::getAppLogger()->level();
+		engine::Logger::getEngineLogger()->set_level(spdlog::level::err);
+		engine::Logger::getAppLogger()->set_level(spdlog::level::err);
+
+		// Timings of kernels giving wrong results would mean nothing
+		if (!checkCollisionKernels()) {
+			APP_ERROR("Batched collision kernels differ from the per pair checks, not benchmarking");
+			std::exit(EXIT_FAILURE);
+		}
+
+		m_Renderer = engine::m_UPtr<engine::Renderer>();
+		benchCollision();
+		benchCulling();
+		benchMeshes();
+		benchShaders();
+		benchBufferLayout();
+		benchEvents();
+		benchQuads();
+		benchMap();
+
+		engine::Logger::getEngineLogger()->set_level(engineLevel);
+		engine::Logger::getAppLogger()->set_level(appLevel);
+
+		m_Runner.logSummary();
+		m_Runner.write();
+		engine::AppFrame::get().closeWindow();
+	}
+
+private:
+	/*
+		Every supported batched kernel against the per pair checks, on each shape count up to 140
+		so the lane blocks, the scalar tails and the second and third hit words are all covered.
+		Shapes sit on a 1/8 grid, sums and squares stay exact and touching edges come up often.
+	*/
+	bool checkCollisionKernels() {
+		Collision collision;
+		std::mt19937 generator(7);
+		std::uniform_int_distribution<int> coordinate(-16, 16), extent(0, 16), radius(1, 8);
+		auto grid = [&](std::uniform_int_distribution<int>& distribution) { return distribution(generator) / 8.0f; };
+
+		const uint32_t maxCount = 140;
+		std::vector<float> x(maxCount), y(maxCount), z(maxCount), width(maxCount), length(maxCount), height(maxCount), radii(maxCount);
+		BoxArrays boxes = { x.data(), y.data(), z.data(), width.data(), length.data(), height.data() };
+		CircleArrays circles = { x.data(), y.data(), z.data(), radii.data() };
+		std::vector<uint64_t> expected(maxCount / 64 + 1), hits(maxCount / 64 + 1);
+
+		CollisionKernel best = Collision::getKernel();
+		uint32_t mismatches = 0;
+		for (uint32_t count = 0; count <= maxCount; count++) {
+			for (uint32_t i = 0; i < count; i++) {
+				x[i] = grid(coordinate);
+				y[i] = grid(coordinate);
+				z[i] = grid(coordinate);
+				width[i] = grid(extent);
+				length[i] = grid(extent);
+				height[i] = grid(extent);
+				radii[i] = grid(radius);
+			}
+			glm::vec3 pos(grid(coordinate), grid(coordinate), grid(coordinate)), size(grid(extent), grid(extent), grid(extent));
+			float queryRadius = grid(radius);
+			size_t words = (count + 63) / 64;
+
+			//overlaps(i) is the per pair check, batch(hits) and first() run the kernel set
+			auto check = [&](const char* test, auto overlaps, auto batch, auto first) {
+				std::fill(expected.begin(), expected.end(), 0);
+				size_t expectedCount = 0, expectedFirst = count;
+				for (uint32_t i = 0; i < count; i++) {
+					if (!overlaps(i)) { continue; }
+					expected[i / 64] |= 1ull << (i % 64);
+					if (expectedFirst == count) { expectedFirst = i; }
+					expectedCount++;
+				}
+				for (const auto& kernel : KERNELS) {
+					if (!Collision::setKernel(kernel.first)) { continue; }
+					bool match = batch(hits.data()) == expectedCount && first() == expectedFirst &&
+						std::equal(hits.begin(), hits.begin() + words, expected.begin());
+					if (!match) {
+						APP_ERROR("{0} with the {1} kernel differs from the per pair check on {2} shapes", test, kernel.second, count);
+						mismatches++;
+					}
+				}
+			};
+
+			check("squareSquare",
+				[&](uint32_t i) { return collision.squareSquare(pos, size, { x[i], y[i], z[i] }, { width[i], length[i], height[i] }); },
+				[&](uint64_t* mask) { return Collision::squareSquareBatch(pos, size, boxes, count, mask); },
+				[&]() { return Collision::firstSquareSquare(pos, size, boxes, count); });
+			check("circleCircle",
+				[&](uint32_t i) { return collision.circleCircle(pos, queryRadius, { x[i], y[i], z[i] }, radii[i]); },
+				[&](uint64_t* mask) { return Collision::circleCircleBatch(pos, queryRadius, circles, count, mask); },
+				[&]() { return Collision::firstCircleCircle(pos, queryRadius, circles, count); });
+			check("circleSquare",
+				[&](uint32_t i) { return collision.circleSquare(pos, queryRadius, { x[i], y[i], z[i] }, { width[i], length[i], height[i] }); },
+				[&](uint64_t* mask) { return Collision::circleSquareBatch(pos, queryRadius, boxes, count, mask); },
+				[&]() { return Collision::firstCircleSquare(pos, queryRadius, boxes, count); });
+		}
+		Collision::setKernel(best);
+		return mismatches == 0;
+	}
+
+	void benchCollision() {
+		auto collision = engine::m_SPtr<Collision>();	// Called through the pointer like Map does
+		for (uint32_t count : { 256u, 1024u, 4096u }) {
+			std::vector<glm::vec3> positions = randomPositions(count);
+			glm::vec3 player(14.0f, 18.0f, 0.0f), size(1.0f), wallSize(0.5f);
+
+			m_Runner.run("collision/squareSquare/" + std::to_string(count), count, [&]() {
+				uint32_t hits = 0;
+				for (const auto& position : positions) {
+					hits += collision->squareSquare(player, size, position, wallSize);
+				}
+				bench::keep(hits);
+			});
+			m_Runner.run("collision/circleCircle/" + std::to_string(count), count, [&]() {
+				uint32_t hits = 0;
+				for (const auto& position : positions) {
+					hits += collision->circleCircle(player, 0.5f, position, 0.5f);
+				}
+				bench::keep(hits);
+			});
+
+			//Same shapes laid out for the batched kernels
+			std::vector<float> x(count), y(count), z(count), sizes(count, 0.5f), radii(count, 0.5f);
+			for (uint32_t i = 0; i < count; i++) {
+				x[i] = positions[i].x;
+				y[i] = positions[i].y;
+				z[i] = positions[i].z;
+			}
+			BoxArrays walls = { x.data(), y.data(), z.data(), sizes.data(), sizes.data(), sizes.data() };
+			CircleArrays circles = { x.data(), y.data(), z.data(), radii.data() };
+			std::vector<uint64_t> mask((count + 63) / 64);
+
+			CollisionKernel best = Collision::getKernel();
+			for (const auto& kernel : KERNELS) {
+				if (!Collision::setKernel(kernel.first)) { continue; }
+				std::string suffix = "/" + std::to_string(count) + "/" + kernel.second;
+
+				m_Runner.run("collision/squareSquareBatch" + suffix, count, [&]() {
+					bench::keep(Collision::squareSquareBatch(player, size, walls, count, mask.data()));
+				});
+				m_Runner.run("collision/circleCircleBatch" + suffix, count, [&]() {
+					bench::keep(Collision::circleCircleBatch(player, 0.5f, circles, count, mask.data()));
+				});
+				m_Runner.run("collision/circleSquareBatch" + suffix, count, [&]() {
+					bench::keep(Collision::circleSquareBatch(player, 0.5f, walls, count, mask.data()));
+				});
+			}
+			Collision::setKernel(best);
+		}
+	}
+
+	/*
+		Per object frustum tests as done for every 3D draw, the maze seen from the game camera
+	*/
+	void benchCulling() {
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(14.0f, 10.0f, 20.0f), glm::vec3(14.0f, 18.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		engine::Frustum frustum(projection * view);
+
+		for (uint32_t count : { 256u, 4096u }) {
+			std::vector<glm::vec3> positions = randomPositions(count);
+			m_Runner.run("culling/sphere/" + std::to_string(count), count, [&]() {
+				uint32_t visible = 0;
+				for (const auto& position : positions) {
+					visible += frustum.intersectsSphere(position, 0.5f);
+				}
+				bench::keep(visible);
+			});
+			m_Runner.run("culling/box/" + std::to_string(count), count, [&]() {
+				uint32_t visible = 0;
+				for (const auto& position : positions) {
+					visible += frustum.intersectsBox(position - 0.5f, position + 0.5f);
+				}
+				bench::keep(visible);
+			});
+		}
+	}
+
+	void benchMeshes() {
+		for (const char* name : { "ghost", "pac" }) {
+			std::string directory = std::string("assets/models/") + name;
+			std::string objPath = directory + "/" + name + ".obj";
+			std::string cookedPath = directory + "/" + name + ".mesh";
+
+			m_Runner.run(std::string("mesh/loadObj/") + name, 1, [&]() {
+				bench::keep(engine::MeshAsset::loadObj(objPath));
+			});
+			if (engine::MeshHandle mesh = engine::MeshAsset::loadObj(objPath)) {
+				m_Runner.run(std::string("mesh/buildLods/") + name, 1, [&]() {
+					bench::keep(engine::MeshSimplifier::buildLods(*mesh, engine::MeshAsset::MAXLODLEVELS));
+				});
+			}
+			if (engine::MeshAsset::loadCooked(cookedPath)) {
+				m_Runner.run(std::string("mesh/loadCooked/") + name, 1, [&]() {
+					bench::keep(engine::MeshAsset::loadCooked(cookedPath));
+				});
+			}
+
+			m_Runner.run(std::string("mesh/loadObjectFromFile/") + name, 1, [&]() {
+				engine::ObjectLibrary library;
+				library.loadObjectFromFile(name, objPath);
+				bench::keep(library);
+			});
+
+			engine::ObjectLibrary library;
+			library.loadObjectFromFile(name, objPath);
+			if (library.exists(name)) {
+				engine::MeshStore object = library.getObject(name);
+				m_Runner.run(std::string("mesh/buildMeshes/") + name, 1, [&]() {
+					bench::keep(object.buildMeshes());
+				});
+			}
+		}
+	}
+
+	void benchShaders() {
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator("assets/shaders", error)) {
+			if (entry.path().extension() != ".glsl") { continue; }
+			std::string source = engine::Shader::readFile(entry.path().string());
+			m_Runner.run("shader/preProcess/" + entry.path().stem().string(), 1, [&]() {
+				bench::keep(engine::Shader::preProcess(source));
+			});
+		}
+	}
+
+	void benchBufferLayout() {
+		using engine::ShaderDataType;
+		m_Runner.run("buffer/BufferLayout/quad", 1, [&]() {
+			engine::BufferLayout layout = {
+				{ ShaderDataType::Float3, "a_Position" },
+				{ ShaderDataType::Float4,	 "a_Color" },
+				{ ShaderDataType::Float2, "a_TexCoord" },
+				{ ShaderDataType::Float,     "a_TexID" },
+				{ ShaderDataType::Float, "a_TileCount" }
+			};
+			bench::keep(layout);
+		});
+		m_Runner.run("buffer/BufferLayout/instance", 1, [&]() {
+			engine::BufferLayout layout = {
+				{ ShaderDataType::Mat4,		   "a_Model" },
+				{ ShaderDataType::Float4, "a_InstanceColor" }
+			};
+			bench::keep(layout);
+		});
+	}
+
+	/*
+		A frame of mouse input handled as it arrives against the same burst queued and dispatched once.
+		Every handled event walks a layer stack like AppFrame::onEvent does.
+	*/
+	void benchEvents() {
+		const uint32_t eventCount = 1000;
+		std::vector<engine::s_Ptr<engine::Layer>> layers(4, engine::m_SPtr<engine::Layer>("BenchEventLayer"));
+		uint32_t handled = 0;
+		engine::EventCallbackFn onEvent = [&](engine::Event& e) {
+			for (auto it = layers.rbegin(); it != layers.rend(); ++it) {
+				(*it)->onEvent(e);
+			}
+			handled++;
+		};
+
+		m_Runner.run("events/immediate/" + std::to_string(eventCount), eventCount, [&]() {
+			for (uint32_t i = 0; i < eventCount; i++) {
+				engine::MouseMovedEvent event((float)i, (float)i);
+				onEvent(event);
+				if (i % 100 == 0) {
+					engine::KeyPressedEvent key(i, 0);
+					onEvent(key);
+				}
+			}
+			bench::keep(handled);
+		});
+
+		engine::EventQueue queue;
+		m_Runner.run("events/queued/" + std::to_string(eventCount), eventCount, [&]() {
+			for (uint32_t i = 0; i < eventCount; i++) {
+				queue.push(engine::MouseMovedEvent((float)i, (float)i));
+				if (i % 100 == 0) {
+					queue.push(engine::KeyPressedEvent(i, 0));
+				}
+			}
+			queue.dispatch(onEvent);
+			bench::keep(handled);
+		});
+		m_Runner.run("events/posted/" + std::to_string(eventCount), eventCount, [&]() {
+			for (uint32_t i = 0; i < eventCount; i++) {
+				queue.post<engine::MouseMovedEvent>((float)i, (float)i);
+			}
+			queue.dispatch(onEvent);
+			bench::keep(handled);
+		});
+	}
+
+	/*
+		Whole 2D frames, vertex generation plus the batch flushes it causes
+	*/
+	void benchQuads() {
+		engine::OrthographicCamera camera(0.0f, 100.0f, 0.0f, 100.0f);
+		auto texture = engine::m_SPtr<engine::Texture>(1, 1);
+		uint32_t white = 0xffffffff;
+		texture->setData(&white, sizeof(uint32_t));
+
+		auto position = [](uint32_t i) { return glm::vec2((float)(i % 100), (float)(i / 100)); };
+		glm::vec2 size(0.9f);
+		glm::vec4 color(1.0f, 0.5f, 0.2f, 1.0f);
+
+		m_Runner.run("renderer/drawQuad/color", QUADCOUNT, [&]() {
+			engine::Renderer::beginScene(camera);
+			for (uint32_t i = 0; i < QUADCOUNT; i++) {
+				engine::Renderer::drawQuad(position(i), size, color);
+			}
+			engine::Renderer::endScene();
+			engine::Renderer::newFrame();
+		});
+		m_Runner.run("renderer/drawQuad/texture", QUADCOUNT, [&]() {
+			engine::Renderer::beginScene(camera);
+			for (uint32_t i = 0; i < QUADCOUNT; i++) {
+				engine::Renderer::drawQuad(position(i), size, texture);
+			}
+			engine::Renderer::endScene();
+			engine::Renderer::newFrame();
+		});
+		m_Runner.run("renderer/drawRotatedQuad/color", QUADCOUNT, [&]() {
+			engine::Renderer::beginScene(camera);
+			for (uint32_t i = 0; i < QUADCOUNT; i++) {
+				engine::Renderer::drawRotatedQuad(position(i), size, (float)i, color);
+			}
+			engine::Renderer::endScene();
+			engine::Renderer::newFrame();
+		});
+	}
+
+	/*
+		level0 and synthetic mazes made of level0 tiled 2x2 and 4x4
+	*/
+	void benchMap() {
+		const std::string level0 = "assets/levels/level0.txt";
+		std::vector<std::pair<std::string, std::string>> levels = { { "level0", level0 } };
+		for (int scale : { 2, 4 }) {
+			std::string path = writeScaledLevel(level0, scale);
+			if (!path.empty()) {
+				levels.push_back({ "level0x" + std::to_string(scale), path });
+			}
+		}
+
+		for (const auto& level : levels) {
+			Map map(level.second);
+			engine::Renderer::clearStaticGeometry();
+
+			m_Runner.run("map/load/" + level.first, 1, [&]() {
+				bench::keep(map.load(level.second));
+			});
+			m_Runner.run("map/construct/" + level.first, 1, [&]() {
+				Map constructed(level.second);
+				engine::Renderer::clearStaticGeometry();
+				bench::keep(constructed);
+			});
+			m_Runner.run("map/onUpdate/" + level.first, 1, [&]() {
+				map.onUpdate(1.0f / 60.0f);
+			});
+
+			// Target alternates between the first and last open tile, every run searches the whole maze
+			FlowField field;
+			field.reset(map.getRow(), map.getColumn(), map.getMapMatrix(), 1);
+			const auto& tiles = map.getMapMatrix();
+			size_t first = std::find_if(tiles.begin(), tiles.end(), [](int tile) { return tile != 1; }) - tiles.begin();
+			size_t last = tiles.rend() - std::find_if(tiles.rbegin(), tiles.rend(), [](int tile) { return tile != 1; }) - 1;
+			bool toFirst = true;
+			m_Runner.run("navigation/flowField/" + level.first, (uint64_t)tiles.size(), [&]() {
+				size_t cell = toFirst ? first : last;
+				toFirst = !toFirst;
+				bench::keep(field.setTarget((int)(cell / map.getColumn()), (int)(cell % map.getColumn())));
+			});
+		}
+	}
+
+	bench::Runner m_Runner;
+	engine::u_Ptr<engine::Renderer> m_Renderer;
+	bool m_Done = false;
+};
+
+class EngineBench : public engine::AppFrame {
+public:
+	EngineBench(engine::WindowSpecs specs) : AppFrame(specs) {
+		pushLayer(NEW BenchLayer);
+	}
+};
+
+/*
+	Null backend unless ENGINE_BACKEND asks for another one
+*/
+engine::u_Ptr<engine::AppFrame> engine::createApp() {
+	auto windowSpecs = engine::WindowSpecs("Engine bench", 1600, 900);
+	windowSpecs.backend = engine::WindowBackend::Null;
+
+	return engine::m_UPtr<EngineBench>(windowSpecs);
+}
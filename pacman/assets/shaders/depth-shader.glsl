@@ -4,12 +4,20 @@
 #version 460 core
 
 layout(location = 0) in vec3 a_Position;
+// Per instance
+layout(location = 5) in mat4 a_Model;
 
-uniform mat4 u_Model = mat4(1.0f);
-uniform mat4 u_LightSpaceMatrix;
+// Shared scene data, uploaded once per scene by the renderer
+layout(std140, binding = 0) uniform Scene {
+	mat4 u_ViewProjection;
+	mat4 u_LightSpaceMatrix;
+	vec3 u_LightColor;
+	vec3 u_LightPosition;
+	vec3 u_ViewPosition;
+};
 
 void main() {
-    gl_Position = u_LightSpaceMatrix * u_Model * vec4(a_Position, 1.0);
+    gl_Position = u_LightSpaceMatrix * a_Model * vec4(a_Position, 1.0);
 }
 
 #type fragment
@@ -8,10 +8,18 @@ layout(location = 1) in vec3 a_Normal;
 layout(location = 2) in vec4 a_Color;
 layout(location = 3) in vec2 a_TexCoord;
 layout(location = 4) in float a_TexID;
-
-uniform mat4 u_ViewProjection;
-uniform mat4 u_Model = mat4(1.0f);
-uniform mat4 u_LightSpaceMatrix;
+// Per instance
+layout(location = 5) in mat4 a_Model;
+layout(location = 9) in vec4 a_InstanceColor;
+
+// Shared scene data, uploaded once per scene by the renderer
+layout(std140, binding = 0) uniform Scene {
+	mat4 u_ViewProjection;
+	mat4 u_LightSpaceMatrix;
+	vec3 u_LightColor;
+	vec3 u_LightPosition;
+	vec3 u_ViewPosition;
+};
 
 out vec3 v_FragPosition;
 out vec4 v_FragPositionLightSpace;
@@ -23,12 +31,12 @@ out float v_TexID;
 
 void main()
 {
-	v_Color = a_Color;
+	v_Color = a_Color * a_InstanceColor;
 	v_TexCoord = a_TexCoord;
 	v_TexID = a_TexID;
 	// For Phong lighting
-	v_FragPosition = vec3(u_Model * vec4(a_Position, 1.0));
-	v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
+	v_FragPosition = vec3(a_Model * vec4(a_Position, 1.0));
+	v_Normal = mat3(transpose(inverse(a_Model))) * a_Normal;
 
     // Shadowmap
     v_FragPositionLightSpace = u_LightSpaceMatrix * vec4(v_FragPosition, 1.0);
@@ -48,12 +56,16 @@ in vec2 v_TexCoord;
 in vec3 v_Normal;
 in float v_TexID;
 
-uniform sampler2D u_Textures[32];
+uniform sampler2D u_Textures[30];		// Leaves room for u_ShadowMap on unit 31 within 32 fragment units
 
-// Lighting specs
-uniform vec3 u_LightColor;
-uniform vec3 u_LightPosition; 
-uniform vec3 u_ViewPosition;
+// Shared scene data, uploaded once per scene by the renderer
+layout(std140, binding = 0) uniform Scene {
+	mat4 u_ViewProjection;
+	mat4 u_LightSpaceMatrix;
+	vec3 u_LightColor;
+	vec3 u_LightPosition;
+	vec3 u_ViewPosition;
+};
 
 // Shadow specs
 uniform sampler2D u_DiffuseTexture; 
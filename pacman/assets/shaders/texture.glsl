@@ -9,7 +9,14 @@ layout(location = 2) in vec2 a_TexCoord;
 layout(location = 3) in float a_TexID;
 layout(location = 4) in float a_TileCount;
 
-uniform mat4 u_ViewProjection;
+// Shared scene data, uploaded once per scene by the renderer
+layout(std140, binding = 0) uniform Scene {
+	mat4 u_ViewProjection;
+	mat4 u_LightSpaceMatrix;
+	vec3 u_LightColor;
+	vec3 u_LightPosition;
+	vec3 u_ViewPosition;
+};
 
 out vec4 v_Color;
 out vec2 v_TexCoord;
@@ -2,125 +2,149 @@
 
 #include <engine/engine.h>
 #include <stdlib.h>
+#include "pacman/include/logic/entity-store.h"
+#include "pacman/include/logic/flow-field.h"
 
-class Ghost {
+//All ghosts of a level, moved together each frame
+class Ghosts {
 public:
-	Ghost();
-
+	//Sprites for rendering, not needed to simulate
 	virtual void loadAssets();
 
-	virtual void onUpdate(engine::Time ts);
+	EntityHandle add(glm::vec3 position, glm::vec3 size);
+
+	//Moves every ghost toward the field's target, ghosts pick their next tile in the middle of a tile
+	//A ghost without a way to the target keeps going straight and stops at walls, its direction is then zero
+	//Ghosts have to start in the middle of a tile
+	virtual void onUpdate(engine::Time ts, const FlowField& field);
 
-	virtual void onRender();
+	//Draws every ghost between its positions of the last two ticks
+	virtual void onRender(float alpha = 1.0f);
 
 	void reset();
+	void clear() { m_Ghosts.clear(); }
 
-	void setDirection(glm::vec3 newDirection) { m_Direction = newDirection; }	void setRandomDirection(int rand);
-	//Mutator method for size field
-	void setSize(glm::vec3 newSize) { m_Size = newSize; }
-	//Mutator method for position field
-	void setPosition(glm::vec3 newPosition) { m_Position = newPosition; }
-	//Accessor method for position field
-	const glm::vec3& getPosition() { return m_Position; }
-	//Mutator method for position field
-	void setNextPosition(glm::vec3 newNextPosition) { m_NextPosition = newNextPosition; }
-	//Accessor method for position field
-	const glm::vec3& getNextPosition() { return m_NextPosition; }
-	//Accessor method for velocity
-	const float getVelocity() { return m_Velocity; }
-	//Mutator method for velocity
-	void setVelocity(int velocity) { m_Velocity = velocity; }
-	//accessor methd for size
-	glm::vec3 getSize() { return m_Size; }
-	float getRadius() { return m_Radius; }
+	void setRandomDirection(uint32_t index, int rand);
+
+	EntityStore& getStore() { return m_Ghosts; }
+	uint32_t size() const { return m_Ghosts.size(); }
 
 private:
-	glm::vec3 m_NextPosition = { 0,0,0 };
-	glm::vec3 m_Position = { 0,0,0 };		//Position of character
-	glm::vec3 m_Rotation = { 0,0,1.f };		//Position of character
-	glm::vec3 m_Direction = { 0.f , 0.f , 0.f };    //Directional vector
-	glm::vec3 m_Size = { 0.8, 0.8, 0.8 };
+	EntityStore m_Ghosts;
 
-	float m_Radius = 0.4f;				//Radius of ghosties
-	float m_Velocity = 2.0f;			//Velocity of character
-	float m_Time = 0.0f;				//Current time
+	static glm::vec3 chooseDirection(const FlowField& field, glm::vec3 tile, glm::vec3 direction);
 
-	glm::vec4 m_Color = { 0.8f, 1.0f, 0.69f, 1.0f };
+	glm::vec3 m_Rotation = { 0,0,1.f };		//Rotation of every ghost
 
 	// 0 = down, 1 = left, 2 = right, 3 = up
 	int m_TextureDirection = 0;
-	int m_DirectionNumber = 2;
 	std::string cycles[4] = { "assets/textures/ghost-down.png",
 							  "assets/textures/ghost-left.png",
 							  "assets/textures/ghost-right.png",
 							  "assets/textures/ghost-up.png" };
 
 	engine::s_Ptr<engine::Texture[]> m_textures[4];
-	std::vector<engine::s_Ptr<engine::Texture>> m_Textures;
+	std::vector<engine::SubTexture> m_Sprites;		// Animation frames, all in one atlas
 };
 
-inline Ghost::Ghost()
-{
-	loadAssets();
-}
-
-void Ghost::loadAssets()
+void Ghosts::loadAssets()
 {
+	// Packed once, later instances reuse the atlas
+	engine::TextureLibrary* textureLibrary = engine::Renderer::getTextureLibrary();
+	textureLibrary->packSprites({ cycles, cycles + 4 });
 	for (int i = 0; i < 4; i++) {
-		m_Textures.push_back(engine::m_SPtr<engine::Texture>(cycles[i]));
+		m_Sprites.push_back(textureLibrary->getSprite(cycles[i]));
 	}
 }
 
-void Ghost::onUpdate(engine::Time ts)
+EntityHandle Ghosts::add(glm::vec3 position, glm::vec3 size)
 {
-	m_Time += ts;
+	EntityHandle ghost = m_Ghosts.create();
+	uint32_t index = m_Ghosts.getIndex(ghost);
+	m_Ghosts.m_Positions[index] = position;
+	m_Ghosts.m_NextPositions[index] = position;
+	m_Ghosts.m_Sizes[index] = size;
+	m_Ghosts.m_Colors[index] = { 0.8f, 1.0f, 0.69f, 1.0f };
+	m_Ghosts.m_Velocities[index] = 2.0f;	//Velocity of ghosts
+	m_Ghosts.m_Radii[index] = 0.4f;			//Radius of ghosties
+	return ghost;
+}
 
-	if (m_Time == 0)
-	{
-		setDirection({ 1,0,0 });
-		ts = 0.001f;
+void Ghosts::onUpdate(engine::Time ts, const FlowField& field)
+{
+	m_Ghosts.m_PreviousPositions = m_Ghosts.m_Positions;
+
+	for (uint32_t i = 0; i < m_Ghosts.size(); i++) {
+		glm::vec3& position = m_Ghosts.m_NextPositions[i];
+		glm::vec3& direction = m_Ghosts.m_Directions[i];
+		position = m_Ghosts.m_Positions[i];
+
+		//Walk the distance of this tick, turning in the middle of every tile passed
+		float distance = ts.getSeconds() * m_Ghosts.m_Velocities[i];
+		while (distance > 0.f) {
+			//Ghosts only turn in the middle of a tile
+			if (position == glm::floor(position)) {
+				direction = chooseDirection(field, position, direction);
+				if (direction == glm::vec3(0.f)) { break; }
+			}
+
+			//Middle of the tile the ghost is heading into
+			glm::vec3 tile = position;
+			if (direction.x != 0.f) { tile.x = direction.x > 0.f ? std::floor(position.x) + 1.f : std::ceil(position.x) - 1.f; }
+			if (direction.y != 0.f) { tile.y = direction.y > 0.f ? std::floor(position.y) + 1.f : std::ceil(position.y) - 1.f; }
+
+			float left = std::abs(tile.x - position.x) + std::abs(tile.y - position.y);
+			if (distance < left) {
+				position += distance * direction;
+				break;
+			}
+			position = tile;
+			distance -= left;
+		}
 	}
-	float timestep = ts.getSeconds();
-
-	//position vector = position + time * m/s * direction vector
-	m_NextPosition.x += timestep * m_Velocity * m_Direction.x;
-	m_NextPosition.y += timestep * m_Velocity * m_Direction.y;
-	m_NextPosition.z += timestep * m_Velocity * m_Direction.z;
-
-	m_Time += ts;
-
-	// ghost kolliderer wall -> wall
+}
 
+glm::vec3 Ghosts::chooseDirection(const FlowField& field, glm::vec3 tile, glm::vec3 direction)
+{
+	int row = (int)tile.x, column = (int)tile.y;
+	FlowField::Direction next = field.getDirection(row, column);
+	if (next != FlowField::None) {
+		return FlowField::getVector(next);
+	}
+	//No way to the target from here, or on it already
+	if (field.isWalkable(row + (int)direction.x, column + (int)direction.y) && direction != glm::vec3(0.f)) {
+		return direction;
+	}
+	return { 0.f, 0.f, 0.f };
 }
 
-void Ghost::onRender()
+void Ghosts::onRender(float alpha)
 {
-	engine::Renderer::draw3DObject({ m_NextPosition.x, m_NextPosition.y, m_NextPosition.z }, 
-		{ m_Size.x, m_Size.y, m_Size.z }, 
-		m_Rotation, m_Color, 
-		"./assets/models/ghost",
-		"ghost");
-	//engine::Renderer::drawQuad({ m_NextPosition.x, m_NextPosition.y, 0.0f }, { m_Size.x, m_Size.y }, m_Textures[m_TextureDirection]);
+	for (uint32_t i = 0; i < m_Ghosts.size(); i++) {
+		engine::Renderer::draw3DObject(lerp(m_Ghosts.m_PreviousPositions[i], m_Ghosts.m_NextPositions[i], alpha), 
+			m_Ghosts.m_Sizes[i], 
+			m_Rotation, m_Ghosts.m_Colors[i], 
+			"ghost",
+			&m_Ghosts.m_Lods[i]);
+	}
+	//engine::Renderer::drawQuad({ m_NextPosition.x, m_NextPosition.y, 0.0f }, { m_Size.x, m_Size.y }, m_Sprites[m_TextureDirection]);
 }
 
-inline void Ghost::setRandomDirection(int rand)
+inline void Ghosts::setRandomDirection(uint32_t index, int rand)
 {
+	glm::vec3& direction = m_Ghosts.m_Directions[index];
 	switch (rand) {
 	case 0:
-		m_DirectionNumber = 0;
-		setDirection({ 0, -1, 0 });
+		direction = { 0, -1, 0 };
 		break;
 	case 1:
-		m_DirectionNumber = 1;
-		setDirection({ -1, 0, 0 });
+		direction = { -1, 0, 0 };
 		break;
 	case 2:
-		m_DirectionNumber = 2;
-		setDirection({ 1, 0, 0 });
+		direction = { 1, 0, 0 };
 		break;
 	case 3:
-		m_DirectionNumber = 3;
-		setDirection({ 0, 1, 0 });
+		direction = { 0, 1, 0 };
 		break;
 	}
 }
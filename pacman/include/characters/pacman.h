@@ -1,16 +1,26 @@
 #pragma once
 
 #include <engine/engine.h>
+
+//Directions asked for by the player, from the keyboard or injected by bots and replays
+struct PlayerInput {
+	bool up = false, down = false, right = false, left = false;
+
+	static PlayerInput fromKeyboard();
+};
+
 class Pacman
 {
 public:
-	Pacman();
+	Pacman() = default;
 
+	//Sprites for rendering, not needed to simulate
 	virtual void loadAssets();
 
-	virtual void onUpdate(engine::Time ts);
+	virtual void onUpdate(engine::Time ts, const PlayerInput& input);
 
-	virtual void onRender();
+	//Draws pacman between its positions of the last two ticks
+	virtual void onRender(float alpha = 1.0f);
 
 	void reset();
 
@@ -19,7 +29,7 @@ public:
 	//Mutator method for position field
 	void setPosition(glm::vec3 newPosition) { m_position = newPosition; }
 	//Accessor method for position field
-	const glm::vec3& getPosition() { return m_position; }
+	const glm::vec3& getPosition() const { return m_position; }
 	//Mutator method for position field
 	void setNextPosition(glm::vec3 newNextPosition) { m_NextPosition = newNextPosition; }
 	//Accessor method for position field
@@ -29,7 +39,7 @@ public:
 	//Mutator method for velocity
 	void setVelocity(float velocity) { m_velocity = velocity; }
 	//Accessor method for rotation
-	float getRotation() { return m_rotation; }
+	float getRotation() const { return m_rotation; }
 	//get Radius
 	float getRadius() { return m_radius; }
 	//accessor methd for size
@@ -42,11 +52,13 @@ private:
 	float m_rotation = 0.0f; //Rotation of the pacman
 	glm::vec3 m_Rotation = { 0.f, 0.f, 0.f };		//Rotation of character in 3d space
 
+	glm::vec3 m_PreviousPosition = { 0,0,0 };	//Position before the last tick
 	glm::vec3 m_NextPosition = { 0,0,0 };
 	glm::vec3 m_position = { 0,0,0 };	   //Position of character
 	glm::vec3 m_direction = {0,0,0};    //Directional vector
 	
 	glm::vec3 m_Size = { m_radius, m_radius, m_radius };
+	engine::LodState m_Lod;		//Level of detail pacman was last drawn with
 
 	//Variables for pacman cycles
 	float m_lastCycle = 0.0f;
@@ -60,29 +72,37 @@ private:
 							  "assets/textures/pacman3.png" };
 
 	engine::s_Ptr<engine::Texture[]> m_textures[4];
-	std::vector<engine::s_Ptr<engine::Texture>> m_Textures;
+	std::vector<engine::SubTexture> m_Sprites;		// Animation frames, all in one atlas
 };
 
 glm::vec3 lerp(glm::vec3 x, glm::vec3 y, float t) {
 	return x * (1.f - t) + y * t;
 }
 
-Pacman::Pacman()
-{
-	loadAssets(); 
+PlayerInput PlayerInput::fromKeyboard() {
+	PlayerInput input;
+	input.up = engine::Input::isKeyPressed(GLFW_KEY_UP);
+	input.down = engine::Input::isKeyPressed(GLFW_KEY_DOWN);
+	input.right = engine::Input::isKeyPressed(GLFW_KEY_RIGHT);
+	input.left = engine::Input::isKeyPressed(GLFW_KEY_LEFT);
+	return input;
 }
 
 void Pacman::loadAssets()
 {
 	//m_texture0 = engine::m_SPtr<engine::Texture>("assets/textures/pacman0.png");
+	// Packed once, later instances reuse the atlas
+	engine::TextureLibrary* textureLibrary = engine::Renderer::getTextureLibrary();
+	textureLibrary->packSprites({ cycles, cycles + 4 });
 	for(int i = 0; i < 4; i++) {
-		m_Textures.push_back(engine::m_SPtr<engine::Texture>(cycles[i]));
+		m_Sprites.push_back(textureLibrary->getSprite(cycles[i]));
 	}
 }
 
 //Ts = time since last frame??
-void Pacman::onUpdate(engine::Time ts) 
+void Pacman::onUpdate(engine::Time ts, const PlayerInput& input) 
 {
+	m_PreviousPosition = m_position;
 	m_time += ts;
 	//Check if pacman needs to change cycle
 	m_lastCycle += ts;
@@ -106,34 +126,34 @@ void Pacman::onUpdate(engine::Time ts)
 
 	//Check if there is input for new direction
 	//W - Upwards
-	if (engine::Input::isKeyPressed(GLFW_KEY_UP)) {
+	if (input.up) {
 		setDirection({ 0, 1, 0 });
 		m_rotation = 90.0f;
 	}
 	//S - Downwards
-	if (engine::Input::isKeyPressed(GLFW_KEY_DOWN)) {
+	if (input.down) {
 		setDirection({ 0, -1, 0 });
 		m_rotation = -90.0f;
 	}
 	//D - right
-	if (engine::Input::isKeyPressed(GLFW_KEY_RIGHT)) {
+	if (input.right) {
 		setDirection({ 1, 0, 0 });
 		m_rotation = 0.0f;
 	}
 	//A - left
-	if (engine::Input::isKeyPressed(GLFW_KEY_LEFT)) {
+	if (input.left) {
 		setDirection({ -1, 0, 0 });
 		m_rotation = 180.0f;
 	}
 }
 
-void Pacman::onRender() 
+void Pacman::onRender(float alpha) 
 {
-	engine::Renderer::draw3DObject(m_NextPosition,
+	engine::Renderer::draw3DObject(lerp(m_PreviousPosition, m_position, alpha),
 		m_Size,
 		m_Rotation, {0, 1, 0, 1},
-		"./assets/models/pac",
-		"pac");
-	//engine::Renderer::drawRotatedQuad({ m_NextPosition.x, m_NextPosition.y, 0.0f}, { m_Size.x, m_Size.y }, m_rotation, m_Textures[cycleNumber]);
+		"pac",
+		&m_Lod);
+	//engine::Renderer::drawRotatedQuad({ m_NextPosition.x, m_NextPosition.y, 0.0f}, { m_Size.x, m_Size.y }, m_rotation, m_Sprites[cycleNumber]);
 }
 
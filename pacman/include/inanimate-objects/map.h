@@ -7,70 +7,85 @@
 #include <random>
 
 #include <pacman/include/logic/collision.h>
+#include <pacman/include/logic/collision-grid.h>
+#include <pacman/include/logic/flow-field.h>
 #include "pacman/include/characters/pacman.h"
 #include "pacman/include/characters/ghost.h"
 #include "pacman/include/inanimate-objects/wall.h"
 #include "pacman/include/inanimate-objects/pellet.h"
 
-//Expected Matrix size
-const int ROWMAX = 28, COLUMNMAX = 36;
-
-// -----------------------------------------------------------------------------
-// RANDOM NUMBER GENERATION
-// -----------------------------------------------------------------------------
-// ask OS for seed for random number gen
-std::random_device rd;
-std::mt19937 rando(rd());
-// restricting number generation between 1 and 30
-std::uniform_int_distribution<int> numDistribution(1, 40);	// Random number 40 is great number
-std::uniform_int_distribution<int> dirDistribution(1, 4);	// Direction
-
 class Map {
 public:
-	Map();
+	//Level seeded from the session seed, so replays spawn and steer ghosts the same
+	Map(const std::string& levelPath = "assets/levels/level0.txt");
+	//Headless maps only simulate, they never touch the renderer, window or input and can run on any thread
+	Map(const std::string& levelPath, uint32_t seed, bool headless = false);
 
-	void load();
+	bool load(const std::string& levelPath);
 	void onUpdate(engine::Time ts);
-	void onRender();
+	void onRender(float alpha = 1.0f);	//Alpha between the last two ticks
+	void setInput(const PlayerInput& input) { m_Input = input; }	//Used by the following updates
 
 	void gameOver();
 	void reset();	// Run when game is over and players/ ghost get back to positions
 
 	bool isGameOver() const { return m_GameOver; }
+	bool isCleared() const { return m_Score == (int)m_Pellets.getStore().size(); }	//Every pellet eaten
+	int getScore() const { return m_Score; }
+	const Pacman& getPlayer() const { return *m_Player; }
 	int getRow() { return m_Row; }	// Accessor method for the row field
 	int getColumn() { return m_Column; }	// Accessor method for the column field
-	void* getMapMatrix() { return m_MapMatrix; }	// Accessor method for the mapMatrix
+	const std::vector<int>& getMapMatrix() const { return m_MapMatrix; }	// Accessor method for the mapMatrix
+	int getTile(int row, int column) const { return m_MapMatrix[row * m_Column + column]; }
 
 private:
-	int m_MapMatrix[ROWMAX][COLUMNMAX];	//2D list that holds all values for the level
-	int m_Row, m_Column;					//Actual RowSize and ColumnSize
+	std::vector<int> m_MapMatrix;			//Values for the level, row by row, sized by the level file
+	int m_Row = 0, m_Column = 0;			//Actual RowSize and ColumnSize
 	int m_Score = 0;
 
 	bool m_GameOver = false;
+	bool m_Headless = false;
+	PlayerInput m_Input;
+
+	// RANDOM NUMBER GENERATION
+	std::mt19937 m_Random;
+	std::uniform_int_distribution<int> m_NumDistribution{ 1, 40 };	// Random number 40 is great number
+	std::uniform_int_distribution<int> m_DirDistribution{ 0, 3 };	// Direction, as handled by Ghosts::setRandomDirection
 
 	engine::ObjectLibrary* s_ObjectLibrary;
 	engine::ShaderLibrary* s_ShaderLibrary;
 
 	engine::s_Ptr<Pacman> m_Player;
-	std::vector<engine::s_Ptr<Ghost>> m_Ghosts;	//Initialising an array of ghosts
+	Ghosts m_Ghosts;	//Every ghost, wall and pellet of the level stored packed by kind
 
-	std::vector<engine::s_Ptr<Wall>> m_Walls;
-	std::vector<engine::s_Ptr<Pellet>> m_Pellets;
+	Walls m_Walls;
+	Pellets m_Pellets;
 
 	engine::s_Ptr <Collision> m_Collision = engine::m_SPtr<Collision>();
+	CollisionGrid m_CollisionGrid;			//Walls and uneaten pellets by tile, filled at load
+	FlowField m_FlowField;					//Ways to pacman's tile for the ghosts
+	std::vector<uint32_t> m_Hits;			//Bodies found by the last grid query, kept to reuse its memory
 };
 
-Map::Map() {
-	load();
+Map::Map(const std::string& levelPath) : Map(levelPath, engine::AppFrame::get().getSeed()) {}
+
+Map::Map(const std::string& levelPath, uint32_t seed, bool headless) : m_Headless(headless), m_Random(seed) {
+	load(levelPath);
 
-	s_ObjectLibrary = engine::Renderer::getObjectLibrary();
-	s_ShaderLibrary = engine::Renderer::getShaderLibrary();
+	// Load map objects in parallel while the level is set up
+	std::vector<engine::AssetHandle<const engine::MeshAsset>> meshes;
+	if (!m_Headless) {
+		s_ObjectLibrary = engine::Renderer::getObjectLibrary();
+		s_ShaderLibrary = engine::Renderer::getShaderLibrary();
 
-	// Load map objects
-	engine::Renderer::loadShape("./assets/models/wall", "wall");
-	engine::Renderer::loadShape("./assets/models/pellet", "pellet");
-	engine::Renderer::loadShape("./assets/models/ghost", "ghost");
-	engine::Renderer::loadShape("./assets/models/pac", "pac");
+		meshes = {
+			engine::Renderer::loadShapeAsync("./assets/models/wall", "wall"),
+			engine::Renderer::loadShapeAsync("./assets/models/pellet", "pellet"),
+			engine::Renderer::loadShapeAsync("./assets/models/ghost", "ghost"),
+			engine::Renderer::loadShapeAsync("./assets/models/pac", "pac")
+		};
+		m_Ghosts.loadAssets();
+	}
 	
 	//s_ObjectLibrary->loadObjectFromFile("wall", "./assets/models/wall/wall.obj");
 	//s_ObjectLibrary->loadObjectFromFile("pellet", "./assets/models/pellet/pellet.obj");
@@ -81,7 +96,6 @@ Map::Map() {
 	//auto lightingShader = s_ShaderLibrary->load("assets/shaders/lighting-shader.glsl");
 
 
-	auto& window = engine::AppFrame::get().getWindow();	// Setup view with camera
 	// wall and vector will use predefined textures by engine
 
 	int randomNumber;
@@ -93,22 +107,27 @@ Map::Map() {
 	// Position from camera
 	glm::vec3 cam = { 0, 0, 0 };
 
+	m_CollisionGrid.reset(m_Row, m_Column);	//Walls and pellets are looked up by tile instead of testing all of them
+	m_FlowField.reset(m_Row, m_Column, m_MapMatrix, 1);
+
 	// Assign all positions per ID
-	for (int i = 0; i < ROWMAX; i++) {
+	for (int i = 0; i < m_Row; i++) {
 		offsetY = 0;
 		offsetX += 0.f;
-		for (int j = 0; j < COLUMNMAX; j++) {
-			int value = m_MapMatrix[i][j];
+		for (int j = 0; j < m_Column; j++) {
+			int value = getTile(i, j);
 			offsetY += 0.f;
 			switch (value) {
 			case 1:		// Wall
 			{
-				m_Walls.push_back(engine::m_SPtr<Wall>(i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z, 0.5f, 0.5f, 0.5f));
+				glm::vec3 position = { i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z }, size = { 0.5f, 0.5f, 0.5f };
+				m_CollisionGrid.add(CollisionGrid::Walls, position, size, m_Walls.add(position, size));
 				break;
 			}
 			case 2:		// Player/Pacman
 			{
 				m_Player = engine::m_SPtr<Pacman>();
+				if (!m_Headless) { m_Player->loadAssets(); }
 				m_Player->setPosition({ i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z });
 				m_Player->setNextPosition({ i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z });
 				m_Player->setSize({ 1.f, 1.f, 1.f });
@@ -116,103 +135,114 @@ Map::Map() {
 				break;
 			}
 			case 0:	// Pellets and Ghosts
-				m_Pellets.push_back(engine::m_SPtr<Pellet>(i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z, 0.1f, 0.1f, 0.1f));
+			{
+				glm::vec3 position = { i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z }, size = { 0.1f, 0.1f, 0.1f };
+				m_CollisionGrid.add(CollisionGrid::Pellets, position, size, m_Pellets.add(position, size));
 	
 				// Ghost random position generation
-				randomNumber = numDistribution(rando);
+				randomNumber = m_NumDistribution(m_Random);
 	
 				// Generate new random number for random ghost placement
 				if (randomNumber == 3 && m_Ghosts.size() < 4) {
-					m_Ghosts.push_back(engine::m_SPtr<Ghost>());
-					m_Ghosts.back()->setPosition({ i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z });
-					m_Ghosts.back()->setNextPosition({ i + offsetX + cam.x, j + offsetY + cam.y, 0.f + cam.z });
-					m_Ghosts.back()->setSize({ 1.f, 1.f, 1.f });
+					m_Ghosts.add(position, { 1.f, 1.f, 1.f });
 				}
 				break;
+			}
 			default:
 				APP_INFO("Unknown ID's on map, was not read");
 				break;
 			}
 		}
 	}
+	if (m_Headless) { return; }
 
+	// Level is complete once its meshes are in the object library
+	for (auto& mesh : meshes) {
+		mesh.wait();
+	}
+
+	//Walls are static, merge them into one buffer for the whole level
+	m_Walls.addToStaticGeometry();
+	engine::Renderer::buildStaticGeometry();
+
+	//Light hangs over the maze on the camera side (-z), slightly off center so walls cast short shadows to one side
+	glm::vec3 center = { m_Row / 2.f, m_Column / 2.f, 0.f };
+	engine::Renderer::setLight(center + glm::vec3(-m_Row / 4.f, -m_Column / 4.f, -m_Column / 2.f), center);
 }
 
-//Loading each object on the map
-void Map::load() {
+//Loading each object on the map, any size given by the first line of the level file
+bool Map::load(const std::string& levelPath) {
+	m_Row = m_Column = 0;
+	m_MapMatrix.clear();
+
 	//Find file that holds the map
-	std::fstream file("assets/levels/level0.txt", std::ios_base::in);
+	std::fstream file(levelPath, std::ios_base::in);
 	//If found, continue
-	if (file) {
-		//Read first line of the level - "28x36"
-		file >> m_Row;				//Get row size - 28
-		file.ignore(1, 'x');		//Ignore the first x in the document
-		file >> m_Column;				//Get column size - 36
-
-		//Iterate over the rest of the document line by line
-		for (int i = 0; i < m_Column; i++) {		//For all columnValues
-			for (int j = 0; j < m_Row; j++) {	//For each rowValues
-				file.ignore();					//Ignore whitespace
-				file >> m_MapMatrix[j][i];
-			}
+	if (!file) {
+		APP_ERROR("Could not read level {0}", levelPath);
+		return false;
+	}
+
+	//Read first line of the level - "28x36"
+	file >> m_Row;				//Get row size - 28
+	file.ignore(1, 'x');		//Ignore the first x in the document
+	file >> m_Column;				//Get column size - 36
+	if (!file || m_Row <= 0 || m_Column <= 0) {
+		APP_ERROR("Level {0} has no valid size", levelPath);
+		m_Row = m_Column = 0;
+		return false;
+	}
+	m_MapMatrix.assign((size_t)m_Row * m_Column, 0);
+
+	//Iterate over the rest of the document line by line
+	for (int i = 0; i < m_Column; i++) {		//For all columnValues
+		for (int j = 0; j < m_Row; j++) {	//For each rowValues
+			file.ignore();					//Ignore whitespace
+			file >> m_MapMatrix[j * m_Column + i];
 		}
 	}
+	return true;
 }
 
 void Map::onUpdate(engine::Time ts) {
-	m_Player->onUpdate(ts);
+	m_Player->onUpdate(ts, m_Input);
 	
-	//Check for collisions between walls and pacman
-	for (auto it : m_Walls) {
-		//Check if the position in the next frame will collide with a wall
-		if (m_Collision->squareSquare(m_Player->getNextPosition(), m_Player->getSize(),
-			it->getPosition(), it->getSize()))
-		{
-			//If it collides, set the next position to be the old position
-			m_Player->setNextPosition(m_Player->getPosition());
-			break;
-		}
-
+	//Check if the position in the next frame will collide with a wall
+	if (m_CollisionGrid.testBox(m_Player->getNextPosition(), m_Player->getSize(), CollisionGrid::Walls)) {
+		//If it collides, set the next position to be the old position
+		m_Player->setNextPosition(m_Player->getPosition());
 	}
 
 	//Pacmans position is now updated
 	m_Player->setPosition(m_Player->getNextPosition());
 
-	//Check for collisions between pacman and ghosts
-	for (auto it : m_Pellets) {
-		if (m_Collision->squareSquare(m_Player->getNextPosition(), m_Player->getSize(),
-			it->getPosition(), it->getSize()))
-		{
-			//If it has not already been ate
-			if (!it->getIsEaten())
-			{
-				it->setEaten();
-				m_Score++;
-			}
-		}
+	//Eat the pellets pacman overlaps, eaten pellets leave the grid
+	m_Hits.clear();
+	m_CollisionGrid.queryBox(m_Player->getNextPosition(), m_Player->getSize(), CollisionGrid::Pellets, m_Hits);
+	for (uint32_t body : m_Hits) {
+		m_Pellets.setEaten(m_CollisionGrid.getEntity(body));
+		m_CollisionGrid.remove(body);
+		m_Score++;
 	}
 
-	//Updating ghosts
-	for (auto ghost : m_Ghosts) {
-		ghost->onUpdate(ts);
-		//Check if they have collided with any walls
-		for (auto wall : m_Walls) {
-			bool collided = m_Collision->squareSquare(ghost->getNextPosition(), ghost->getSize(),
-				wall->getPosition(), wall->getSize());
-			if (collided)
-			{
-				//If the ghost collides, we set the next position to be the old one
-				ghost->setNextPosition(ghost->getPosition());
-				//Find a new direction for the ghost
-				ghost->setRandomDirection(dirDistribution(rando));
-				break;
-			}
+	//Ghosts follow the ways to pacman's tile, only searched again when pacman enters another tile
+	const glm::vec3& player = m_Player->getPosition();
+	m_FlowField.setTarget((int)std::floor(player.x + 0.5f), (int)std::floor(player.y + 0.5f));
+
+	//Updating ghosts, they only walk on open tiles so walls need no test
+	m_Ghosts.onUpdate(ts, m_FlowField);
+	EntityStore& ghosts = m_Ghosts.getStore();
+	for (uint32_t i = 0; i < ghosts.size(); i++) {
+		//A ghost stopped without a way to pacman tries a new direction
+		if (ghosts.m_Directions[i] == glm::vec3(0.f))
+		{
+			m_Ghosts.setRandomDirection(i, m_DirDistribution(m_Random));
 		}
 		//The iterated ghosts position is now updated
-		ghost->setPosition(ghost->getNextPosition());
+		ghosts.m_Positions[i] = ghosts.m_NextPositions[i];
 		//Check if Ghost collides with Pacman
 		if (m_Collision->circleCircle(m_Player->getPosition(), m_Player->getRadius(),
-			ghost->getPosition(), ghost->getRadius()))
+			ghosts.m_Positions[i], ghosts.m_Radii[i]))
 
 		{
 			gameOver();
@@ -224,25 +254,21 @@ void Map::onUpdate(engine::Time ts) {
 }
 
 //Renders the objects on the screen, objects declared first will be rendered last etc
-void Map::onRender() {
+void Map::onRender(float alpha) {
 	
 	//Draw ghosts
-	for (auto it : m_Ghosts) {
-		it->onRender();
-	}
+	m_Ghosts.onRender(alpha);
 	
-	//Draw walls
-	for (auto it : m_Walls) {
-		it->onRender();
-	}
+	//Walls are drawn by the renderer as baked static geometry
 
 	//Draw pac
-	m_Player->onRender();
+	m_Player->onRender(alpha);
 	
-	//Draw pellets
-	for (auto it : m_Pellets) {
-		it->onRender();
-	}
+	//Draw pellets, every job records an interleaved share of them on its own thread
+	uint32_t jobCount = engine::Renderer::getRecordJobCount();
+	engine::Renderer::recordParallel(jobCount, [this, jobCount](engine::CommandBuffer& commands, uint32_t job) {
+		m_Pellets.onRender(commands, job, jobCount);
+	});
 	
 	
 }
@@ -253,7 +279,7 @@ void Map::onRender() {
 */
 void Map::gameOver() {
 	m_GameOver = true;
-	APP_INFO(m_Score);
+	if (!m_Headless) { APP_INFO(m_Score); }
 }
 
 void Map::reset() {
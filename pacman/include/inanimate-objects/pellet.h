@@ -1,40 +1,44 @@
 #include <engine/engine.h>
 #include "pacman/include/color.h"
+#include "pacman/include/logic/entity-store.h"
 
-class Pellet {
+//All pellets of a level, eaten pellets stay in the store with their alive flag cleared
+class Pellets {
 public:
-	Pellet(float x, float y, float z, float width, float length, float height) {
-		setPosition({ x , y, z });
-		setSize({ width, length, height });
-	};
-
-	void setPosition(glm::vec3 newPosition) { position = newPosition; }
-	void setSize(glm::vec3 newSize) { size = newSize; }
-	void onRender();
-	void setEaten() { isEaten = true; }
-	bool getIsEaten() { return isEaten; }
-	glm::vec3 getPosition() { return position; }
-	glm::vec3 getSize() { return size; }
+	EntityHandle add(glm::vec3 position, glm::vec3 size);
+	void onRender(engine::CommandBuffer& commands, uint32_t job, uint32_t jobCount);	// Recorded on worker threads
+	void setEaten(EntityHandle pellet) { m_Pellets.m_Alive[m_Pellets.getIndex(pellet)] = 0; }
+	bool getIsEaten(EntityHandle pellet) const { return !m_Pellets.m_Alive[m_Pellets.getIndex(pellet)]; }
+	void clear() { m_Pellets.clear(); }
 
+	EntityStore& getStore() { return m_Pellets; }
+	const EntityStore& getStore() const { return m_Pellets; }
 private:
-	bool isEaten = false;
-	glm::vec3 position;
-	glm::vec3 size;
-	glm::vec4 colour = color::PelletYellow;
+	EntityStore m_Pellets;
 };
 
-void Pellet::onRender() {
-	if (isEaten == false)
-	{
-		engine::Renderer::draw3DObject({ position.x, position.y, position.z },
-			{ size.x, size.y, size.z },
-			{ 0, 0, 0 },
-			colour,
-			"./assets/models/pellet",
-			"pellet");
-		//engine::Renderer::drawCircle({ position.x, position.y }, { size.x, size.y }, colour);
-	}
-	else { 
-		return; 
+EntityHandle Pellets::add(glm::vec3 position, glm::vec3 size) {
+	EntityHandle pellet = m_Pellets.create();
+	uint32_t index = m_Pellets.getIndex(pellet);
+	m_Pellets.m_Positions[index] = position;
+	m_Pellets.m_NextPositions[index] = position;
+	m_Pellets.m_Sizes[index] = size;
+	m_Pellets.m_Colors[index] = color::PelletYellow;
+	return pellet;
+}
+
+//Every job records an interleaved share of the pellets
+void Pellets::onRender(engine::CommandBuffer& commands, uint32_t job, uint32_t jobCount) {
+	for (uint32_t i = job; i < m_Pellets.size(); i += jobCount) {
+		if (m_Pellets.m_Alive[i])
+		{
+			commands.draw3DObject(m_Pellets.m_Positions[i],
+				m_Pellets.m_Sizes[i],
+				{ 0, 0, 0 },
+				m_Pellets.m_Colors[i],
+				"pellet",
+				&m_Pellets.m_Lods[i]);
+			//engine::Renderer::drawCircle({ position.x, position.y }, { size.x, size.y }, colour);
+		}
 	}
-}
\ No newline at end of file
+}
@@ -1,31 +1,37 @@
 #include <engine/engine.h>
 #include "pacman/include/color.h"
+#include "pacman/include/logic/entity-store.h"
 
-class Wall {
+//All walls of a level, stored packed in one entity store
+class Walls {
 public:
-	Wall(float x, float y, float z, float width, float length, float height) {
-		setPosition({ x , y, z });
-		setSize({ width, length, height});
-	};
+	EntityHandle add(glm::vec3 position, glm::vec3 size);
+	void addToStaticGeometry();
+	void clear() { m_Walls.clear(); }
 
-	void setPosition(glm::vec3 newPosition) { position = newPosition; }
-	void setSize(glm::vec3 newSize) { size = newSize; }
-	void onRender();
-
-	glm::vec3 getSize() { return size; }
-	glm::vec3 getPosition() { return position; }
+	EntityStore& getStore() { return m_Walls; }
 private:
-	glm::vec3 position;
-	glm::vec3 size;
-	glm::vec4 colour = color::WallBlue;
+	EntityStore m_Walls;
 };
 
-void Wall::onRender(){
-	engine::Renderer::draw3DObject({ position.x, position.y, position.z }, 
-		{ size.x, size.y, size.z }, 
-		{ 0, 0, 0 }, 
-		colour,
-		"./assets/models/wall",
-		"wall");
+EntityHandle Walls::add(glm::vec3 position, glm::vec3 size) {
+	EntityHandle wall = m_Walls.create();
+	uint32_t index = m_Walls.getIndex(wall);
+	m_Walls.m_Positions[index] = position;
+	m_Walls.m_NextPositions[index] = position;
+	m_Walls.m_Sizes[index] = size;
+	m_Walls.m_Colors[index] = color::WallBlue;
+	return wall;
+}
+
+//Walls never move, they are baked with the rest of the level and drawn in one call
+void Walls::addToStaticGeometry(){
+	for (uint32_t i = 0; i < m_Walls.size(); i++) {
+		engine::Renderer::addStaticObject(m_Walls.m_Positions[i], 
+			m_Walls.m_Sizes[i], 
+			{ 0, 0, 0 }, 
+			m_Walls.m_Colors[i],
+			"wall");
+	}
 	//engine::Renderer::drawQuad({ position.x, position.y }, { size.x, size.x }, colour);
-}
\ No newline at end of file
+}
@@ -11,6 +11,7 @@ public:
 	void onDetach() override;
 
 	void onUpdate(engine::Time ts) override;
+	void onFixedUpdate(engine::Time step) override;
 	void onEvent(engine::Event& e) override;
 	void setCamera(uint32_t width, uint32_t height);
 
@@ -23,6 +24,8 @@ private:
 
 	State m_State = State::InGame;
 	float m_Time = 0.0f;				// Time elapsed since game start
+	float m_StatsTime = 0.0f;			// Time since renderer statistics were last logged
+	const float STATSINTERVAL = 5.0f;	// Seconds between renderer statistics in the log
 
 	engine::u_Ptr<Map> m_Map;
 
@@ -37,7 +40,7 @@ private:
 	Layer constructor
 	- Defines default aspect ratio of camera
 */
-GameLayer::GameLayer() : engine::Layer(), m_CameraController(1600.0f/900.0f, 90.f, true) {
+GameLayer::GameLayer() : engine::Layer("GameLayer"), m_CameraController(1600.0f/900.0f, 90.f, true) {
 	m_Map = engine::m_UPtr<Map>();
 
 	auto& window = engine::AppFrame::get().getWindow();	// Setup view with camera
@@ -51,20 +54,22 @@ GameLayer::GameLayer() : engine::Layer(), m_CameraController(1600.0f/900.0f, 90.
 	// OPTIONS
 
 	// CULLING
-	glEnable(GL_CULL_FACE);
-	glCullFace(GL_BACK);
+	engine::RenderAPI::setFaceCulling(true);
+	engine::RenderAPI::setCullFace(GL_BACK);
 
 	// Turn on blending for OpenGL
-	glEnable(GL_BLEND);
-	glEnable(GL_DEPTH_TEST);
+	engine::RenderAPI::setBlending(true);
+	engine::RenderAPI::setDepthTest(true);
 
 	// When blending uses the inverse of src texture to determine drawing priority
 	// In this case the destination texture is only drawn if RGBA values of src are 0
 	// Allowing "transparency" in textures
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	engine::RenderAPI::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Focus mouse on window when it is active and tie to middle of screen
-	glfwSetInputMode(static_cast<GLFWwindow*>(window.getNativeWindow()), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	if (window.getNativeWindow()) {		// No cursor when headless
+		glfwSetInputMode(static_cast<GLFWwindow*>(window.getNativeWindow()), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
 }
 
 
@@ -77,16 +82,9 @@ void GameLayer::onDetach() {
 }
 
 /*
-	Game loop
+	Simulation tick, the game plays the same at any frame rate and in replays
 */
-void GameLayer::onUpdate(engine::Time ts) {
-	m_Time += ts;
-
-	//auto& window = engine::AppFrame::get().getWindow();	// Setup view with camera
-	//setCamera(window.getWidth(), window.getHeight());
-	//m_Camera->setPosition({ m_Map->getRow()/2.f, m_Map->getColumn() / 2.f, 0 });
-	m_CameraController.onUpdate(ts);
-
+void GameLayer::onFixedUpdate(engine::Time step) {
 	// Checks if game is over
 	if (m_Map->isGameOver()) {										// Check for game over from level
 		m_State = State::GameOver;									// Set layer state to game over
@@ -95,11 +93,30 @@ void GameLayer::onUpdate(engine::Time ts) {
 	// Only updates entities if game in play
 	switch (m_State) {		// Game states
 		case State::InGame: {							// Game still in play
-			m_Map->onUpdate(ts);	// Run game loop protocol for level
+			m_Map->setInput(PlayerInput::fromKeyboard());
+			m_Map->onUpdate(step);	// Run game loop protocol for level
 			break;
 		}
 	}
+}
 
+/*
+	Game loop, renders the latest ticks
+*/
+void GameLayer::onUpdate(engine::Time ts) {
+	m_Time += ts;
+
+	// Renderer statistics of the previous frame, for spotting performance regressions in any run
+	m_StatsTime += ts;
+	if (m_StatsTime >= STATSINTERVAL) {
+		m_StatsTime = 0.0f;
+		engine::Renderer::logStats();
+	}
+
+	//auto& window = engine::AppFrame::get().getWindow();	// Setup view with camera
+	//setCamera(window.getWidth(), window.getHeight());
+	//m_Camera->setPosition({ m_Map->getRow()/2.f, m_Map->getColumn() / 2.f, 0 });
+	m_CameraController.onUpdate(ts);
 
 	// Render API draw calls
 	engine::Renderer::get().setClearColor({ 0.0f, 0.0f,0.0f, 1.f });
@@ -108,7 +125,7 @@ void GameLayer::onUpdate(engine::Time ts) {
 	// Camera scene init with view projection data setup
 	engine::Renderer::beginScene(m_CameraController.getCamera());
 	
-	m_Map->onRender();
+	m_Map->onRender(engine::AppFrame::get().getInterpolation());
 	
 	engine::Renderer::endScene();
 }
@@ -40,19 +40,19 @@ private:
 	Layer constructor
 	- Defines default aspect ratio of camera
 
-SandboxLayer::SandboxLayer() : Layer(), m_CameraController(1600.0f / 900.0f) {
+SandboxLayer::SandboxLayer() : Layer("SandboxLayer"), m_CameraController(1600.0f / 900.0f) {
 	// Init rendering api
 	engine::u_Ptr<engine::Renderer> s_Renderer = engine::m_UPtr<engine::Renderer>();
 
 	// OPTIONS
 
 	// Turn on blending for OpenGL
-	glEnable(GL_BLEND);
-	glEnable(GL_DEPTH_TEST);
+	engine::RenderAPI::setBlending(true);
+	engine::RenderAPI::setDepthTest(true);
 	// When blending uses the inverse of src texture to determine drawing priority
 	// In this case the destination texture is only drawn if RGBA values of src are 0
 	// Allowing "transparency" in textures
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	engine::RenderAPI::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <engine/engine.h>
+#include <pacman/include/logic/entity-store.h>
+
+//Uniform grid over the maze for collision queries, bodies are boxes registered in every cell they overlap
+//Queries only look at the cells around the tested shape, cost does not grow with the number of bodies
+class CollisionGrid {
+public:
+	//Layers are bits, queries take a mask of the layers they test against
+	enum Layer : uint32_t {
+		Walls = 1 << 0,
+		Pellets = 1 << 1,
+		All = 0xffffffff
+	};
+
+	//Covers rows x columns cells starting at origin, bodies outside are kept in the border cells
+	void reset(int rows, int columns, float cellSize = 1.0f, glm::vec2 origin = { 0.f, 0.f });
+
+	//Box from position to position + size like Collision::squareSquare, entity is returned by getEntity
+	uint32_t add(Layer layer, glm::vec3 position, glm::vec3 size, EntityHandle entity);
+	void remove(uint32_t body);
+	EntityHandle getEntity(uint32_t body) const { return m_Bodies[body].entity; }
+	size_t getBodyCount() const { return m_BodyCount; }
+
+	//True if any body of the layers overlaps the shape
+	bool testBox(glm::vec3 position, glm::vec3 size, uint32_t layers);
+	bool testCircle(glm::vec3 center, float radius, uint32_t layers);
+
+	//Appends every body of the layers overlapping the shape to bodies, each body once
+	void queryBox(glm::vec3 position, glm::vec3 size, uint32_t layers, std::vector<uint32_t>& bodies);
+	void queryCircle(glm::vec3 center, float radius, uint32_t layers, std::vector<uint32_t>& bodies);
+
+private:
+	struct Body {
+		glm::vec3 min, max;
+		Layer layer;
+		EntityHandle entity;
+		uint32_t stamp = 0;		//Last query that visited the body
+		bool alive = true;
+	};
+
+	struct CellRange {
+		int firstRow, lastRow, firstColumn, lastColumn;
+	};
+
+	CellRange getCells(glm::vec2 min, glm::vec2 max) const;
+	static bool overlapsBox(const Body& body, glm::vec3 min, glm::vec3 max);
+	static bool overlapsCircle(const Body& body, glm::vec3 center, float radius);
+
+	//Visits bodies of the layers in the cells, stops when visit returns true
+	template<typename F>
+	bool visit(const CellRange& cells, uint32_t layers, F&& visitBody);
+
+	std::vector<Body> m_Bodies;
+	std::vector<std::vector<uint32_t>> m_Cells;		//Body ids, row by row
+	size_t m_BodyCount = 0;
+	int m_Rows = 0, m_Columns = 0;
+	float m_CellSize = 1.0f;
+	glm::vec2 m_Origin = { 0.f, 0.f };
+	uint32_t m_Stamp = 0;
+};
+
+void CollisionGrid::reset(int rows, int columns, float cellSize, glm::vec2 origin) {
+	m_Bodies.clear();
+	m_Cells.assign((size_t)rows * columns, {});
+	m_BodyCount = 0;
+	m_Rows = rows;
+	m_Columns = columns;
+	m_CellSize = cellSize;
+	m_Origin = origin;
+	m_Stamp = 0;
+}
+
+uint32_t CollisionGrid::add(Layer layer, glm::vec3 position, glm::vec3 size, EntityHandle entity) {
+	uint32_t body = (uint32_t)m_Bodies.size();
+	m_Bodies.push_back({ position, position + size, layer, entity });
+
+	CellRange cells = getCells(position, position + size);
+	for (int row = cells.firstRow; row <= cells.lastRow; row++) {
+		for (int column = cells.firstColumn; column <= cells.lastColumn; column++) {
+			m_Cells[(size_t)row * m_Columns + column].push_back(body);
+		}
+	}
+	m_BodyCount++;
+	return body;
+}
+
+//Takes the body out of its cells, ids of other bodies stay valid
+void CollisionGrid::remove(uint32_t body) {
+	Body& removed = m_Bodies[body];
+	if (!removed.alive) { return; }
+	removed.alive = false;
+
+	CellRange cells = getCells(removed.min, removed.max);
+	for (int row = cells.firstRow; row <= cells.lastRow; row++) {
+		for (int column = cells.firstColumn; column <= cells.lastColumn; column++) {
+			auto& cell = m_Cells[(size_t)row * m_Columns + column];
+			auto it = std::find(cell.begin(), cell.end(), body);
+			if (it != cell.end()) {
+				*it = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+	m_BodyCount--;
+}
+
+template<typename F>
+bool CollisionGrid::visit(const CellRange& cells, uint32_t layers, F&& visitBody) {
+	if (m_Cells.empty()) { return false; }
+	m_Stamp++;		//Bodies in several cells are visited once per query
+	for (int row = cells.firstRow; row <= cells.lastRow; row++) {
+		for (int column = cells.firstColumn; column <= cells.lastColumn; column++) {
+			for (uint32_t id : m_Cells[(size_t)row * m_Columns + column]) {
+				Body& body = m_Bodies[id];
+				if (!(body.layer & layers) || body.stamp == m_Stamp) { continue; }
+				body.stamp = m_Stamp;
+				if (visitBody(body)) { return true; }
+			}
+		}
+	}
+	return false;
+}
+
+bool CollisionGrid::testBox(glm::vec3 position, glm::vec3 size, uint32_t layers) {
+	glm::vec3 max = position + size;
+	return visit(getCells(position, max), layers, [&](const Body& body) {
+		return overlapsBox(body, position, max);
+	});
+}
+
+bool CollisionGrid::testCircle(glm::vec3 center, float radius, uint32_t layers) {
+	glm::vec2 extent = { radius, radius };
+	return visit(getCells(glm::vec2(center) - extent, glm::vec2(center) + extent), layers, [&](const Body& body) {
+		return overlapsCircle(body, center, radius);
+	});
+}
+
+void CollisionGrid::queryBox(glm::vec3 position, glm::vec3 size, uint32_t layers, std::vector<uint32_t>& bodies) {
+	glm::vec3 max = position + size;
+	visit(getCells(position, max), layers, [&](const Body& body) {
+		if (overlapsBox(body, position, max)) {
+			bodies.push_back((uint32_t)(&body - m_Bodies.data()));
+		}
+		return false;
+	});
+}
+
+void CollisionGrid::queryCircle(glm::vec3 center, float radius, uint32_t layers, std::vector<uint32_t>& bodies) {
+	glm::vec2 extent = { radius, radius };
+	visit(getCells(glm::vec2(center) - extent, glm::vec2(center) + extent), layers, [&](const Body& body) {
+		if (overlapsCircle(body, center, radius)) {
+			bodies.push_back((uint32_t)(&body - m_Bodies.data()));
+		}
+		return false;
+	});
+}
+
+//Cells covering min to max on the x (row) and y (column) axis, clamped to the grid
+CollisionGrid::CellRange CollisionGrid::getCells(glm::vec2 min, glm::vec2 max) const {
+	auto clamp = [](float value, int count) {
+		int cell = (int)std::floor(value);
+		return cell < 0 ? 0 : (cell >= count ? count - 1 : cell);
+	};
+	return {
+		clamp((min.x - m_Origin.x) / m_CellSize, m_Rows), clamp((max.x - m_Origin.x) / m_CellSize, m_Rows),
+		clamp((min.y - m_Origin.y) / m_CellSize, m_Columns), clamp((max.y - m_Origin.y) / m_CellSize, m_Columns)
+	};
+}
+
+//Same test as Collision::squareSquare, touching boxes do not overlap
+bool CollisionGrid::overlapsBox(const Body& body, glm::vec3 min, glm::vec3 max) {
+	return max.x > body.min.x && body.max.x > min.x &&
+		max.y > body.min.y && body.max.y > min.y &&
+		max.z > body.min.z && body.max.z > min.z;
+}
+
+//Distance from the center to the closest point of the box
+bool CollisionGrid::overlapsCircle(const Body& body, glm::vec3 center, float radius) {
+	glm::vec3 closest = glm::clamp(center, body.min, body.max);
+	glm::vec3 distance = center - closest;
+	return glm::dot(distance, distance) <= radius * radius;
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <engine/engine.h>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define COLLISION_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define COLLISION_TARGET_AVX2
+	#else
+		#define COLLISION_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+	//SSE2 is part of every x86-64 target, 32-bit builds need it enabled
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define COLLISION_SSE2
+	#endif
+#endif
+
+//Shapes tested in batches, one float array per component so SIMD lanes load neighbouring shapes
+//Boxes go from x, y, z to x + width, y + length, z + height like Collision::squareSquare
+struct BoxArrays {
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* width;
+	const float* length;
+	const float* height;
+};
+
+struct CircleArrays {
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* radius;
+};
+
+//Instruction set the batched collision tests run with
+enum class CollisionKernel {
+	Scalar, SSE2, AVX2
+};
+
+//Batched collision tests, one query shape against the shapes begin to end of the arrays
+//Kernels either set a bit in hits for every overlap and return the overlap count,
+//or with first set return the index of the first overlap, end if there is none
+namespace kernels {
+
+	struct BoxQuery {
+		glm::vec3 min, max;
+	};
+
+	struct CircleQuery {
+		glm::vec3 center;
+		float radius;
+	};
+
+	typedef size_t(*BoxBoxKernel)(const BoxQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first);
+	typedef size_t(*CircleCircleKernel)(const CircleQuery& query, const CircleArrays& circles, size_t begin, size_t end, uint64_t* hits, bool first);
+	typedef size_t(*CircleBoxKernel)(const CircleQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first);
+
+	inline uint32_t countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	inline uint32_t countBits(uint32_t mask) {
+		uint32_t count = 0;
+		for (; mask; mask &= mask - 1) { count++; }
+		return count;
+	}
+
+	//Stores the overlaps of the lanes starting at index, kernels start at 0 so lane blocks never cross a 64 bit word
+	inline void setHits(uint64_t* hits, size_t index, uint32_t mask) {
+		hits[index / 64] |= (uint64_t)mask << (index % 64);
+	}
+
+	// SCALAR
+
+	inline size_t boxBoxScalar(const BoxQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first) {
+		size_t count = 0;
+		for (size_t i = begin; i < end; i++) {
+			bool hit = query.max.x > boxes.x[i] && boxes.x[i] + boxes.width[i] > query.min.x &&
+				query.max.y > boxes.y[i] && boxes.y[i] + boxes.length[i] > query.min.y &&
+				query.max.z > boxes.z[i] && boxes.z[i] + boxes.height[i] > query.min.z;
+			if (!hit) { continue; }
+			if (first) { return i; }
+			setHits(hits, i, 1);
+			count++;
+		}
+		return first ? end : count;
+	}
+
+	inline size_t circleCircleScalar(const CircleQuery& query, const CircleArrays& circles, size_t begin, size_t end, uint64_t* hits, bool first) {
+		size_t count = 0;
+		for (size_t i = begin; i < end; i++) {
+			float dx = query.center.x - circles.x[i], dy = query.center.y - circles.y[i], dz = query.center.z - circles.z[i];
+			float reach = query.radius + circles.radius[i];
+			if (dx * dx + dy * dy + dz * dz > reach * reach) { continue; }
+			if (first) { return i; }
+			setHits(hits, i, 1);
+			count++;
+		}
+		return first ? end : count;
+	}
+
+	inline float distanceToRange(float value, float min, float max) {
+		return value < min ? min - value : (value > max ? value - max : 0.f);
+	}
+
+	inline size_t circleBoxScalar(const CircleQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first) {
+		size_t count = 0;
+		for (size_t i = begin; i < end; i++) {
+			float dx = distanceToRange(query.center.x, boxes.x[i], boxes.x[i] + boxes.width[i]);
+			float dy = distanceToRange(query.center.y, boxes.y[i], boxes.y[i] + boxes.length[i]);
+			float dz = distanceToRange(query.center.z, boxes.z[i], boxes.z[i] + boxes.height[i]);
+			if (dx * dx + dy * dy + dz * dz > query.radius * query.radius) { continue; }
+			if (first) { return i; }
+			setHits(hits, i, 1);
+			count++;
+		}
+		return first ? end : count;
+	}
+
+#ifdef COLLISION_SSE2
+	// SSE2, 4 shapes per instruction
+
+	inline size_t boxBoxSSE2(const BoxQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first) {
+		const __m128 minX = _mm_set1_ps(query.min.x), minY = _mm_set1_ps(query.min.y), minZ = _mm_set1_ps(query.min.z);
+		const __m128 maxX = _mm_set1_ps(query.max.x), maxY = _mm_set1_ps(query.max.y), maxZ = _mm_set1_ps(query.max.z);
+		size_t count = 0, i = begin;
+		for (; i + 4 <= end; i += 4) {
+			__m128 x = _mm_loadu_ps(boxes.x + i), y = _mm_loadu_ps(boxes.y + i), z = _mm_loadu_ps(boxes.z + i);
+			__m128 hit = _mm_and_ps(_mm_cmpgt_ps(maxX, x), _mm_cmpgt_ps(_mm_add_ps(x, _mm_loadu_ps(boxes.width + i)), minX));
+			hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpgt_ps(maxY, y), _mm_cmpgt_ps(_mm_add_ps(y, _mm_loadu_ps(boxes.length + i)), minY)));
+			hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpgt_ps(maxZ, z), _mm_cmpgt_ps(_mm_add_ps(z, _mm_loadu_ps(boxes.height + i)), minZ)));
+			uint32_t mask = (uint32_t)_mm_movemask_ps(hit);
+			if (!mask) { continue; }
+			if (first) { return i + countTrailingZeros(mask); }
+			setHits(hits, i, mask);
+			count += countBits(mask);
+		}
+		size_t rest = boxBoxScalar(query, boxes, i, end, hits, first);
+		return first ? rest : count + rest;
+	}
+
+	inline size_t circleCircleSSE2(const CircleQuery& query, const CircleArrays& circles, size_t begin, size_t end, uint64_t* hits, bool first) {
+		const __m128 centerX = _mm_set1_ps(query.center.x), centerY = _mm_set1_ps(query.center.y), centerZ = _mm_set1_ps(query.center.z);
+		const __m128 radius = _mm_set1_ps(query.radius);
+		size_t count = 0, i = begin;
+		for (; i + 4 <= end; i += 4) {
+			__m128 dx = _mm_sub_ps(centerX, _mm_loadu_ps(circles.x + i));
+			__m128 dy = _mm_sub_ps(centerY, _mm_loadu_ps(circles.y + i));
+			__m128 dz = _mm_sub_ps(centerZ, _mm_loadu_ps(circles.z + i));
+			__m128 reach = _mm_add_ps(radius, _mm_loadu_ps(circles.radius + i));
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_cmple_ps(distance, _mm_mul_ps(reach, reach)));
+			if (!mask) { continue; }
+			if (first) { return i + countTrailingZeros(mask); }
+			setHits(hits, i, mask);
+			count += countBits(mask);
+		}
+		size_t rest = circleCircleScalar(query, circles, i, end, hits, first);
+		return first ? rest : count + rest;
+	}
+
+	//Distance per axis is how far the center is clamped into the box
+	inline size_t circleBoxSSE2(const CircleQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first) {
+		const __m128 centerX = _mm_set1_ps(query.center.x), centerY = _mm_set1_ps(query.center.y), centerZ = _mm_set1_ps(query.center.z);
+		const __m128 radius = _mm_set1_ps(query.radius * query.radius);
+		size_t count = 0, i = begin;
+		for (; i + 4 <= end; i += 4) {
+			__m128 x = _mm_loadu_ps(boxes.x + i), y = _mm_loadu_ps(boxes.y + i), z = _mm_loadu_ps(boxes.z + i);
+			__m128 dx = _mm_sub_ps(centerX, _mm_min_ps(_mm_max_ps(centerX, x), _mm_add_ps(x, _mm_loadu_ps(boxes.width + i))));
+			__m128 dy = _mm_sub_ps(centerY, _mm_min_ps(_mm_max_ps(centerY, y), _mm_add_ps(y, _mm_loadu_ps(boxes.length + i))));
+			__m128 dz = _mm_sub_ps(centerZ, _mm_min_ps(_mm_max_ps(centerZ, z), _mm_add_ps(z, _mm_loadu_ps(boxes.height + i))));
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_cmple_ps(distance, radius));
+			if (!mask) { continue; }
+			if (first) { return i + countTrailingZeros(mask); }
+			setHits(hits, i, mask);
+			count += countBits(mask);
+		}
+		size_t rest = circleBoxScalar(query, boxes, i, end, hits, first);
+		return first ? rest : count + rest;
+	}
+#endif
+
+#ifdef COLLISION_X86
+	// AVX2, 8 shapes per instruction, only called when the CPU supports it
+
+	COLLISION_TARGET_AVX2 inline size_t boxBoxAVX2(const BoxQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first) {
+		const __m256 minX = _mm256_set1_ps(query.min.x), minY = _mm256_set1_ps(query.min.y), minZ = _mm256_set1_ps(query.min.z);
+		const __m256 maxX = _mm256_set1_ps(query.max.x), maxY = _mm256_set1_ps(query.max.y), maxZ = _mm256_set1_ps(query.max.z);
+		size_t count = 0, i = begin;
+		for (; i + 8 <= end; i += 8) {
+			__m256 x = _mm256_loadu_ps(boxes.x + i), y = _mm256_loadu_ps(boxes.y + i), z = _mm256_loadu_ps(boxes.z + i);
+			__m256 hit = _mm256_and_ps(_mm256_cmp_ps(maxX, x, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_add_ps(x, _mm256_loadu_ps(boxes.width + i)), minX, _CMP_GT_OQ));
+			hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(maxY, y, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_add_ps(y, _mm256_loadu_ps(boxes.length + i)), minY, _CMP_GT_OQ)));
+			hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(maxZ, z, _CMP_GT_OQ), _mm256_cmp_ps(_mm256_add_ps(z, _mm256_loadu_ps(boxes.height + i)), minZ, _CMP_GT_OQ)));
+			uint32_t mask = (uint32_t)_mm256_movemask_ps(hit);
+			if (!mask) { continue; }
+			if (first) { return i + countTrailingZeros(mask); }
+			setHits(hits, i, mask);
+			count += countBits(mask);
+		}
+		size_t rest = boxBoxScalar(query, boxes, i, end, hits, first);
+		return first ? rest : count + rest;
+	}
+
+	COLLISION_TARGET_AVX2 inline size_t circleCircleAVX2(const CircleQuery& query, const CircleArrays& circles, size_t begin, size_t end, uint64_t* hits, bool first) {
+		const __m256 centerX = _mm256_set1_ps(query.center.x), centerY = _mm256_set1_ps(query.center.y), centerZ = _mm256_set1_ps(query.center.z);
+		const __m256 radius = _mm256_set1_ps(query.radius);
+		size_t count = 0, i = begin;
+		for (; i + 8 <= end; i += 8) {
+			__m256 dx = _mm256_sub_ps(centerX, _mm256_loadu_ps(circles.x + i));
+			__m256 dy = _mm256_sub_ps(centerY, _mm256_loadu_ps(circles.y + i));
+			__m256 dz = _mm256_sub_ps(centerZ, _mm256_loadu_ps(circles.z + i));
+			__m256 reach = _mm256_add_ps(radius, _mm256_loadu_ps(circles.radius + i));
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+			uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_mul_ps(reach, reach), _CMP_LE_OQ));
+			if (!mask) { continue; }
+			if (first) { return i + countTrailingZeros(mask); }
+			setHits(hits, i, mask);
+			count += countBits(mask);
+		}
+		size_t rest = circleCircleScalar(query, circles, i, end, hits, first);
+		return first ? rest : count + rest;
+	}
+
+	COLLISION_TARGET_AVX2 inline size_t circleBoxAVX2(const CircleQuery& query, const BoxArrays& boxes, size_t begin, size_t end, uint64_t* hits, bool first) {
+		const __m256 centerX = _mm256_set1_ps(query.center.x), centerY = _mm256_set1_ps(query.center.y), centerZ = _mm256_set1_ps(query.center.z);
+		const __m256 radius = _mm256_set1_ps(query.radius * query.radius);
+		size_t count = 0, i = begin;
+		for (; i + 8 <= end; i += 8) {
+			__m256 x = _mm256_loadu_ps(boxes.x + i), y = _mm256_loadu_ps(boxes.y + i), z = _mm256_loadu_ps(boxes.z + i);
+			__m256 dx = _mm256_sub_ps(centerX, _mm256_min_ps(_mm256_max_ps(centerX, x), _mm256_add_ps(x, _mm256_loadu_ps(boxes.width + i))));
+			__m256 dy = _mm256_sub_ps(centerY, _mm256_min_ps(_mm256_max_ps(centerY, y), _mm256_add_ps(y, _mm256_loadu_ps(boxes.length + i))));
+			__m256 dz = _mm256_sub_ps(centerZ, _mm256_min_ps(_mm256_max_ps(centerZ, z), _mm256_add_ps(z, _mm256_loadu_ps(boxes.height + i))));
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+			uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(distance, radius, _CMP_LE_OQ));
+			if (!mask) { continue; }
+			if (first) { return i + countTrailingZeros(mask); }
+			setHits(hits, i, mask);
+			count += countBits(mask);
+		}
+		size_t rest = circleBoxScalar(query, boxes, i, end, hits, first);
+		return first ? rest : count + rest;
+	}
+
+	//AVX2 needs the CPU and the OS saving the wider registers
+	inline bool cpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) { return false; }
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) { return false; }
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	struct KernelTable {
+		CollisionKernel kernel;
+		BoxBoxKernel boxBox;
+		CircleCircleKernel circleCircle;
+		CircleBoxKernel circleBox;
+	};
+
+	inline bool isSupported(CollisionKernel kernel) {
+		switch (kernel) {
+		case CollisionKernel::Scalar: return true;
+#ifdef COLLISION_SSE2
+		case CollisionKernel::SSE2: return true;
+#endif
+#ifdef COLLISION_X86
+		case CollisionKernel::AVX2: {
+			static bool avx2 = cpuSupportsAVX2();
+			return avx2;
+		}
+#endif
+		default: return false;
+		}
+	}
+
+	inline KernelTable makeTable(CollisionKernel kernel) {
+		switch (kernel) {
+#ifdef COLLISION_X86
+		case CollisionKernel::AVX2: return { kernel, boxBoxAVX2, circleCircleAVX2, circleBoxAVX2 };
+#endif
+#ifdef COLLISION_SSE2
+		case CollisionKernel::SSE2: return { kernel, boxBoxSSE2, circleCircleSSE2, circleBoxSSE2 };
+#endif
+		default: return { CollisionKernel::Scalar, boxBoxScalar, circleCircleScalar, circleBoxScalar };
+		}
+	}
+
+	//Widest supported instruction set, picked on first use
+	inline KernelTable& getTable() {
+		static KernelTable table = makeTable(isSupported(CollisionKernel::AVX2) ? CollisionKernel::AVX2 :
+			(isSupported(CollisionKernel::SSE2) ? CollisionKernel::SSE2 : CollisionKernel::Scalar));
+		return table;
+	}
+
+}
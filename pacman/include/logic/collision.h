@@ -1,6 +1,7 @@
 #pragma once
 
 #include <engine/engine.h>
+#include <pacman/include/logic/collision-kernels.h>
 //Static class for collision calculation for circle & ball and square & cube shapes
 class Collision {
 
@@ -11,6 +12,21 @@ public:
 	virtual bool circleSquare(glm::vec3 pos1, float radius1, glm::vec3 pos2, glm::vec3 size2);
 	//Checks if two squares are overlapping
 	virtual bool squareSquare(glm::vec3 pos1, glm::vec3 size1, glm::vec3 pos2, glm::vec3 size2);
+
+	//Batched checks of one shape against count shapes, run with the widest instruction set the CPU has
+	//hits gets one bit per shape, (count + 63) / 64 words, returns the number of overlapping shapes
+	static size_t squareSquareBatch(glm::vec3 pos, glm::vec3 size, const BoxArrays& squares, size_t count, uint64_t* hits);
+	static size_t circleCircleBatch(glm::vec3 pos, float radius, const CircleArrays& circles, size_t count, uint64_t* hits);
+	static size_t circleSquareBatch(glm::vec3 pos, float radius, const BoxArrays& squares, size_t count, uint64_t* hits);
+
+	//Index of the first overlapping shape, count if none overlaps
+	static size_t firstSquareSquare(glm::vec3 pos, glm::vec3 size, const BoxArrays& squares, size_t count);
+	static size_t firstCircleCircle(glm::vec3 pos, float radius, const CircleArrays& circles, size_t count);
+	static size_t firstCircleSquare(glm::vec3 pos, float radius, const BoxArrays& squares, size_t count);
+
+	//Instruction set of the batched checks, setKernel returns false if the CPU lacks it
+	static CollisionKernel getKernel() { return kernels::getTable().kernel; }
+	static bool setKernel(CollisionKernel kernel);
 };
 
 bool Collision::circleCircle(glm::vec3 pos1, float radius1, glm::vec3 pos2, float radius2) {
@@ -27,7 +43,11 @@ bool Collision::circleCircle(glm::vec3 pos1, float radius1, glm::vec3 pos2, floa
 }
 
 bool Collision::circleSquare(glm::vec3 pos1, float radius1, glm::vec3 pos2, glm::vec3 size2) {
-	return false;
+	//Find the point of the square closest to the circle centre
+	glm::vec3 closest = glm::clamp(pos1, pos2, pos2 + size2);
+	//If the centre is closer to it than the radius, they are overlapping
+	glm::vec3 distanceVector = pos1 - closest;
+	return glm::dot(distanceVector, distanceVector) <= radius1 * radius1;
 }
 
 bool Collision::squareSquare(glm::vec3 pos1, glm::vec3 size1, glm::vec3 pos2, glm::vec3 size2) {
@@ -45,3 +65,36 @@ bool Collision::squareSquare(glm::vec3 pos1, glm::vec3 size1, glm::vec3 pos2, gl
 
 	return false;
 }
+
+size_t Collision::squareSquareBatch(glm::vec3 pos, glm::vec3 size, const BoxArrays& squares, size_t count, uint64_t* hits) {
+	std::memset(hits, 0, (count + 63) / 64 * sizeof(uint64_t));
+	return kernels::getTable().boxBox({ pos, pos + size }, squares, 0, count, hits, false);
+}
+
+size_t Collision::circleCircleBatch(glm::vec3 pos, float radius, const CircleArrays& circles, size_t count, uint64_t* hits) {
+	std::memset(hits, 0, (count + 63) / 64 * sizeof(uint64_t));
+	return kernels::getTable().circleCircle({ pos, radius }, circles, 0, count, hits, false);
+}
+
+size_t Collision::circleSquareBatch(glm::vec3 pos, float radius, const BoxArrays& squares, size_t count, uint64_t* hits) {
+	std::memset(hits, 0, (count + 63) / 64 * sizeof(uint64_t));
+	return kernels::getTable().circleBox({ pos, radius }, squares, 0, count, hits, false);
+}
+
+size_t Collision::firstSquareSquare(glm::vec3 pos, glm::vec3 size, const BoxArrays& squares, size_t count) {
+	return kernels::getTable().boxBox({ pos, pos + size }, squares, 0, count, nullptr, true);
+}
+
+size_t Collision::firstCircleCircle(glm::vec3 pos, float radius, const CircleArrays& circles, size_t count) {
+	return kernels::getTable().circleCircle({ pos, radius }, circles, 0, count, nullptr, true);
+}
+
+size_t Collision::firstCircleSquare(glm::vec3 pos, float radius, const BoxArrays& squares, size_t count) {
+	return kernels::getTable().circleBox({ pos, radius }, squares, 0, count, nullptr, true);
+}
+
+bool Collision::setKernel(CollisionKernel kernel) {
+	if (!kernels::isSupported(kernel)) { return false; }
+	kernels::getTable() = kernels::makeTable(kernel);
+	return true;
+}
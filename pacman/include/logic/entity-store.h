@@ -0,0 +1,146 @@
+#pragma once
+
+#include <engine/engine.h>
+
+//Reference to an entity in an EntityStore, a destroyed entity's handle never matches a newer entity
+struct EntityHandle {
+	static const uint32_t INVALID = 0xffffffff;
+
+	uint32_t slot = INVALID;
+	uint32_t generation = 0;
+
+	bool operator==(const EntityHandle& other) const { return slot == other.slot && generation == other.generation; }
+	bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+//Entities of one kind stored as a structure of arrays, element i of every component array is entity i
+//Arrays stay packed, destroying an entity moves the last entity into its place so loops never skip holes
+//Handles stay valid through moves, indices are only valid until the next destroy
+class EntityStore {
+public:
+	EntityHandle create();
+	void destroy(EntityHandle entity);
+	void clear();
+	void reserve(size_t count);
+
+	bool contains(EntityHandle entity) const;
+	uint32_t getIndex(EntityHandle entity) const;		//Index into the component arrays
+	EntityHandle getHandle(uint32_t index) const { return { m_Slots[index], m_Generations[m_Slots[index]] }; }
+	uint32_t size() const { return (uint32_t)m_Slots.size(); }
+
+public:
+	//Components, every entity has all of them
+	std::vector<glm::vec3>			m_Positions;
+	std::vector<glm::vec3>			m_NextPositions;	//Position after this frame's move, before collisions
+	std::vector<glm::vec3>			m_PreviousPositions;	//Position before the last tick, for interpolated rendering
+	std::vector<glm::vec3>			m_Sizes;
+	std::vector<glm::vec3>			m_Directions;
+	std::vector<glm::vec4>			m_Colors;
+	std::vector<float>				m_Velocities;
+	std::vector<float>				m_Radii;
+	std::vector<uint8_t>			m_Alive;			//Cleared instead of destroying when the entity may come back
+	std::vector<engine::LodState>	m_Lods;				//Level of detail the entity was last drawn with
+
+private:
+	std::vector<uint32_t> m_Indices;		//Component index of each slot
+	std::vector<uint32_t> m_Generations;	//Bumped when the slot's entity is destroyed
+	std::vector<uint32_t> m_Slots;			//Slot of each component index
+	std::vector<uint32_t> m_FreeSlots;
+};
+
+EntityHandle EntityStore::create() {
+	uint32_t slot;
+	if (!m_FreeSlots.empty()) {
+		slot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else {
+		slot = (uint32_t)m_Indices.size();
+		m_Indices.push_back(0);
+		m_Generations.push_back(0);
+	}
+	m_Indices[slot] = size();
+	m_Slots.push_back(slot);
+
+	m_Positions.push_back({ 0.f, 0.f, 0.f });
+	m_NextPositions.push_back({ 0.f, 0.f, 0.f });
+	m_PreviousPositions.push_back({ 0.f, 0.f, 0.f });
+	m_Sizes.push_back({ 1.f, 1.f, 1.f });
+	m_Directions.push_back({ 0.f, 0.f, 0.f });
+	m_Colors.push_back({ 1.f, 1.f, 1.f, 1.f });
+	m_Velocities.push_back(0.f);
+	m_Radii.push_back(0.f);
+	m_Alive.push_back(1);
+	m_Lods.push_back({});
+	return { slot, m_Generations[slot] };
+}
+
+void EntityStore::destroy(EntityHandle entity) {
+	if (!contains(entity)) { return; }
+	uint32_t index = m_Indices[entity.slot];
+	uint32_t last = size() - 1;
+
+	//Move the last entity into the hole
+	auto move = [index, last](auto& components) {
+		components[index] = components[last];
+		components.pop_back();
+	};
+	move(m_Positions);
+	move(m_NextPositions);
+	move(m_PreviousPositions);
+	move(m_Sizes);
+	move(m_Directions);
+	move(m_Colors);
+	move(m_Velocities);
+	move(m_Radii);
+	move(m_Alive);
+	move(m_Lods);
+
+	m_Slots[index] = m_Slots[last];
+	m_Indices[m_Slots[index]] = index;
+	m_Slots.pop_back();
+
+	m_Generations[entity.slot]++;
+	m_FreeSlots.push_back(entity.slot);
+}
+
+void EntityStore::clear() {
+	for (uint32_t slot : m_Slots) {
+		m_Generations[slot]++;
+		m_FreeSlots.push_back(slot);
+	}
+	m_Slots.clear();
+	m_Positions.clear();
+	m_NextPositions.clear();
+	m_PreviousPositions.clear();
+	m_Sizes.clear();
+	m_Directions.clear();
+	m_Colors.clear();
+	m_Velocities.clear();
+	m_Radii.clear();
+	m_Alive.clear();
+	m_Lods.clear();
+}
+
+void EntityStore::reserve(size_t count) {
+	m_Slots.reserve(count);
+	m_Positions.reserve(count);
+	m_NextPositions.reserve(count);
+	m_PreviousPositions.reserve(count);
+	m_Sizes.reserve(count);
+	m_Directions.reserve(count);
+	m_Colors.reserve(count);
+	m_Velocities.reserve(count);
+	m_Radii.reserve(count);
+	m_Alive.reserve(count);
+	m_Lods.reserve(count);
+}
+
+bool EntityStore::contains(EntityHandle entity) const {
+	return entity.slot < m_Generations.size() && m_Generations[entity.slot] == entity.generation;
+}
+
+uint32_t EntityStore::getIndex(EntityHandle entity) const {
+	ENGINE_ASSERT(contains(entity), "Entity was destroyed!");
+	return m_Indices[entity.slot];
+}
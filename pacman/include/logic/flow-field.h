@@ -0,0 +1,103 @@
+#pragma once
+
+#include <engine/engine.h>
+
+//Breadth first search over the maze tiles toward one target tile, every tile keeps its distance and first step
+//The field is only rebuilt when the target moves to another tile, agents then find their way with one lookup
+//Cost grows with the maze, not with the number of agents
+class FlowField {
+public:
+	//Same order as Ghosts::setRandomDirection
+	enum Direction : uint8_t {
+		Down = 0, Left = 1, Right = 2, Up = 3,
+		None = 4	//Target tile, walls and tiles without a way to the target
+	};
+	static constexpr uint32_t UNREACHABLE = 0xffffffff;
+
+	//Tiles row by row like Map::getTile, every tile but blocked ones can be walked
+	void reset(int rows, int columns, const std::vector<int>& tiles, int blocked);
+
+	//Rebuilds the field if the tile differs from the current target, returns true if it did
+	bool setTarget(int row, int column);
+
+	Direction getDirection(int row, int column) const { return contains(row, column) ? m_Directions[getCell(row, column)] : None; }
+	uint32_t getDistance(int row, int column) const { return contains(row, column) ? m_Distances[getCell(row, column)] : UNREACHABLE; }
+	bool isWalkable(int row, int column) const { return contains(row, column) && m_Walkable[getCell(row, column)]; }
+	bool contains(int row, int column) const { return row >= 0 && row < m_Rows && column >= 0 && column < m_Columns; }
+
+	static glm::vec3 getVector(Direction direction);
+	static glm::ivec2 getOffset(Direction direction);
+	uint32_t getRebuildCount() const { return m_Rebuilds; }
+
+private:
+	size_t getCell(int row, int column) const { return (size_t)row * m_Columns + column; }
+
+	int m_Rows = 0, m_Columns = 0;
+	int m_TargetRow = -1, m_TargetColumn = -1;
+	uint32_t m_Rebuilds = 0;
+
+	std::vector<uint8_t> m_Walkable;
+	std::vector<uint32_t> m_Distances;		//Steps to the target
+	std::vector<Direction> m_Directions;	//First step toward the target
+	std::vector<uint32_t> m_Queue;			//Kept to reuse its memory between rebuilds
+};
+
+void FlowField::reset(int rows, int columns, const std::vector<int>& tiles, int blocked) {
+	m_Rows = rows;
+	m_Columns = columns;
+	m_TargetRow = m_TargetColumn = -1;
+	m_Walkable.resize(tiles.size());
+	for (size_t i = 0; i < tiles.size(); i++) {
+		m_Walkable[i] = tiles[i] != blocked;
+	}
+	m_Distances.assign(tiles.size(), UNREACHABLE);
+	m_Directions.assign(tiles.size(), None);
+	m_Queue.reserve(tiles.size());
+}
+
+bool FlowField::setTarget(int row, int column) {
+	if (!isWalkable(row, column) || (row == m_TargetRow && column == m_TargetColumn)) { return false; }
+	m_TargetRow = row;
+	m_TargetColumn = column;
+	m_Rebuilds++;
+
+	std::fill(m_Distances.begin(), m_Distances.end(), UNREACHABLE);
+	std::fill(m_Directions.begin(), m_Directions.end(), None);
+
+	//Search outward from the target, a tile reached from a neighbour steps back into that neighbour
+	m_Queue.clear();
+	m_Queue.push_back((uint32_t)getCell(row, column));
+	m_Distances[m_Queue.back()] = 0;
+	for (size_t next = 0; next < m_Queue.size(); next++) {
+		uint32_t cell = m_Queue[next];
+		int cellRow = cell / m_Columns, cellColumn = cell % m_Columns;
+		for (uint8_t direction = Down; direction <= Up; direction++) {
+			glm::ivec2 offset = getOffset((Direction)direction);
+			int neighbourRow = cellRow + offset.x, neighbourColumn = cellColumn + offset.y;
+			if (!isWalkable(neighbourRow, neighbourColumn)) { continue; }
+			size_t neighbour = getCell(neighbourRow, neighbourColumn);
+			if (m_Distances[neighbour] != UNREACHABLE) { continue; }
+
+			m_Distances[neighbour] = m_Distances[cell] + 1;
+			m_Directions[neighbour] = (Direction)(Up - direction);	//Opposite of the step taken, Down<->Up and Left<->Right
+			m_Queue.push_back((uint32_t)neighbour);
+		}
+	}
+	return true;
+}
+
+//Rows run along x and columns along y, like the positions the map gives its tiles
+glm::vec3 FlowField::getVector(Direction direction) {
+	glm::ivec2 offset = getOffset(direction);
+	return { (float)offset.x, (float)offset.y, 0.f };
+}
+
+glm::ivec2 FlowField::getOffset(Direction direction) {
+	switch (direction) {
+		case Down:	return { 0, -1 };
+		case Left:	return { -1, 0 };
+		case Right:	return { 1, 0 };
+		case Up:	return { 0, 1 };
+		default:	return { 0, 0 };
+	}
+}
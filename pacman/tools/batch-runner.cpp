@@ -0,0 +1,190 @@
+/*
+	pacman_batch - simulates many independent games in parallel, without a window or renderer.
+	Every game gets its own seed and a bot player, results are aggregated and logged.
+	Runs on the null backend unless ENGINE_BACKEND asks for another one, nothing is drawn either way.
+
+	Options from the environment:
+		PACMAN_BATCH_GAMES		Games to simulate, default 1000
+		PACMAN_BATCH_TICKS		Tick limit of a game, default 18000 (5 minutes at 60 ticks per second)
+		PACMAN_BATCH_SEED		Seed of the first game, game i uses seed + i, default 1
+		PACMAN_BATCH_THREADS	Worker threads, default one per hardware thread
+		PACMAN_BATCH_LEVEL		Level file, default assets/levels/level0.txt
+		PACMAN_BATCH_OUT		CSV file written with one line per game
+*/
+#include <engine/engine.h>
+#include <engine/include/thread-pool.h>
+
+#include "pacman/include/inanimate-objects/map.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+	const float STEP = 1.0f / 60.0f;	// Same tick as the game
+
+	uint32_t environmentNumber(const char* name, uint32_t fallback) {
+		const char* value = std::getenv(name);
+		return value ? (uint32_t)std::strtoul(value, nullptr, 10) : fallback;
+	}
+
+	/*
+		Player that runs in a random direction and picks a new one every 15 to 60 ticks
+	*/
+	class RandomBot {
+	public:
+		RandomBot(uint32_t seed) : m_Random(seed) {}
+
+		PlayerInput next() {
+			if (m_TicksLeft == 0) {
+				m_Direction = std::uniform_int_distribution<int>(0, 3)(m_Random);
+				m_TicksLeft = std::uniform_int_distribution<uint32_t>(15, 60)(m_Random);
+			}
+			m_TicksLeft--;
+
+			PlayerInput input;
+			input.up = m_Direction == 0;
+			input.down = m_Direction == 1;
+			input.right = m_Direction == 2;
+			input.left = m_Direction == 3;
+			return input;
+		}
+
+	private:
+		std::mt19937 m_Random;
+		int m_Direction = 0;
+		uint32_t m_TicksLeft = 0;
+	};
+
+	struct GameResult {
+		enum Outcome { Caught, Cleared, TimedOut };
+
+		uint32_t seed = 0;
+		uint32_t ticks = 0;
+		int score = 0;
+		Outcome outcome = TimedOut;
+	};
+
+	const char* getOutcomeName(GameResult::Outcome outcome) {
+		switch (outcome) {
+			case GameResult::Caught: return "caught";
+			case GameResult::Cleared: return "cleared";
+			default: return "timeout";
+		}
+	}
+
+	/*
+		One game from start to end, only touches its own map and bot so games can run on any thread
+	*/
+	GameResult simulate(const std::string& levelPath, uint32_t seed, uint32_t maxTicks) {
+		Map map(levelPath, seed, true);
+		RandomBot bot(seed ^ 0x9e3779b9);	// Own stream, the bot does not shift the ghosts' random numbers
+
+		GameResult result;
+		result.seed = seed;
+		while (result.ticks < maxTicks && !map.isGameOver() && !map.isCleared()) {
+			map.setInput(bot.next());
+			map.onUpdate(STEP);
+			result.ticks++;
+		}
+		result.score = map.getScore();
+		result.outcome = map.isGameOver() ? GameResult::Caught : (map.isCleared() ? GameResult::Cleared : GameResult::TimedOut);
+		return result;
+	}
+
+}
+
+class BatchLayer : public engine::Layer {
+public:
+	BatchLayer() : engine::Layer("BatchLayer") {}
+
+	void onUpdate(engine::Time ts) override {
+		if (m_Done) { return; }
+		m_Done = true;
+
+		uint32_t gameCount = environmentNumber("PACMAN_BATCH_GAMES", 1000);
+		uint32_t maxTicks = environmentNumber("PACMAN_BATCH_TICKS", 18000);
+		uint32_t firstSeed = environmentNumber("PACMAN_BATCH_SEED", 1);
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		uint32_t threadCount = environmentNumber("PACMAN_BATCH_THREADS", hardwareThreads ? hardwareThreads : 1);
+		const char* level = std::getenv("PACMAN_BATCH_LEVEL");
+		std::string levelPath = level ? level : "assets/levels/level0.txt";
+
+		if (Map(levelPath, firstSeed, true).getRow() == 0) {	// Fail once here instead of in every game
+			engine::AppFrame::get().closeWindow();
+			return;
+		}
+
+		// Workers take the next game until none are left, games vary a lot in length
+		std::vector<GameResult> results(gameCount);
+		std::atomic<uint32_t> nextGame{ 0 };
+		auto start = std::chrono::steady_clock::now();
+		{
+			engine::ThreadPool pool(threadCount);
+			std::vector<std::future<void>> workers;
+			for (uint32_t i = 0; i < pool.getThreadCount(); i++) {
+				workers.push_back(pool.submit([&]() {
+					for (uint32_t game = nextGame++; game < gameCount; game = nextGame++) {
+						results[game] = simulate(levelPath, firstSeed + game, maxTicks);
+					}
+				}));
+			}
+			for (auto& worker : workers) {
+				worker.wait();
+			}
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		report(results, threadCount, seconds);
+		engine::AppFrame::get().closeWindow();
+	}
+
+private:
+	void report(const std::vector<GameResult>& results, uint32_t threadCount, double seconds) {
+		uint64_t ticks = 0, score = 0;
+		int maxScore = 0;
+		uint32_t outcomes[3] = {};
+		for (const auto& result : results) {
+			ticks += result.ticks;
+			score += result.score;
+			maxScore = result.score > maxScore ? result.score : maxScore;
+			outcomes[result.outcome]++;
+		}
+
+		size_t games = results.size();
+		double perGame = games ? 1.0 / games : 0.0;
+		APP_INFO("{0} games on {1} threads in {2:.3f}s: {3:.1f} games/s, {4:.0f} ticks/s", games, threadCount, seconds,
+			seconds > 0.0 ? games / seconds : 0.0, seconds > 0.0 ? ticks / seconds : 0.0);
+		APP_INFO("Score mean {0:.1f}, max {1}, ticks mean {2:.0f}", score * perGame, maxScore, ticks * perGame);
+		APP_INFO("Caught {0}, cleared {1}, timed out {2}", outcomes[GameResult::Caught], outcomes[GameResult::Cleared],
+			outcomes[GameResult::TimedOut]);
+
+		if (const char* path = std::getenv("PACMAN_BATCH_OUT")) {
+			std::ofstream file(path);
+			if (!file) {
+				APP_ERROR("Could not write batch results to {0}", path);
+				return;
+			}
+			file << "seed,ticks,score,outcome\n";
+			for (const auto& result : results) {
+				file << result.seed << ',' << result.ticks << ',' << result.score << ',' << getOutcomeName(result.outcome) << '\n';
+			}
+		}
+	}
+
+	bool m_Done = false;
+};
+
+class PacmanBatch : public engine::AppFrame {
+public:
+	PacmanBatch(engine::WindowSpecs specs) : AppFrame(specs) {
+		pushLayer(NEW BatchLayer);
+	}
+};
+
+engine::u_Ptr<engine::AppFrame> engine::createApp() {
+	auto windowSpecs = engine::WindowSpecs("Pacman batch", 1600, 900);
+	windowSpecs.backend = engine::WindowBackend::Null;
+
+	return engine::m_UPtr<PacmanBatch>(windowSpecs);
+}
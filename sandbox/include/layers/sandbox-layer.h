@@ -45,12 +45,12 @@ SandboxLayer::SandboxLayer() : engine::Layer(), m_CameraController(1600.0f / 900
 	// OPTIONS
 
 	// Turn on blending for OpenGL
-	glEnable(GL_BLEND);
-	glEnable(GL_DEPTH_TEST);
+	engine::RenderAPI::setBlending(true);
+	engine::RenderAPI::setDepthTest(true);
 	// When blending uses the inverse of src texture to determine drawing priority
 	// In this case the destination texture is only drawn if RGBA values of src are 0
 	// Allowing "transparency" in textures
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	engine::RenderAPI::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 
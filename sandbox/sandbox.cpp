@@ -14,12 +14,12 @@ public:
 		// OPTIONS
 		
 		// Turn on blending for OpenGL
-		glEnable(GL_BLEND);
-		glEnable(GL_DEPTH_TEST);
+		engine::RenderAPI::setBlending(true);
+		engine::RenderAPI::setDepthTest(true);
 		// When blending uses the inverse of src texture to determine drawing priority
 		// In this case the destination texture is only drawn if RGBA values of src are 0
 		// Allowing "transparency" in textures
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		engine::RenderAPI::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	}
 
 	~ExampleLayer() {